@@ -0,0 +1,190 @@
+// ContinuousJog.cpp
+#include "ContinuousJog.h"
+#include "TinybeeController.h"
+#include <cmath>
+
+ContinuousJog::ContinuousJog(TinyBeeController *controller, QObject *parent)
+    : QObject(parent), m_controller(controller)
+{
+    m_clock.start();
+    m_stopTimer.setSingleShot(true);
+
+    connect(&m_fillTimer, &QTimer::timeout, this, &ContinuousJog::fill);
+    connect(&m_stopTimer, &QTimer::timeout, this, &ContinuousJog::onStopTimeout);
+    connect(m_controller, &TinyBeeController::commandCompleted, this, [this](quint64 id, const QString &)
+            { onCommandFinished(id); });
+    connect(m_controller, &TinyBeeController::commandFailed, this, [this](quint64 id, const QString &)
+            { onCommandFinished(id); });
+    connect(m_controller, &TinyBeeController::positionUpdated, this, &ContinuousJog::onPositionUpdated);
+    connect(m_controller, &TinyBeeController::disconnected, this, [this]()
+            {
+        m_active = false;
+        m_relative = false;
+        m_stopping = false;
+        m_outstanding.clear();
+        m_fillTimer.stop();
+        m_stopTimer.stop(); });
+}
+
+void ContinuousJog::setFeedrate(int mmPerMin)
+{
+    m_feedrate = qMax(1, mmPerMin);
+}
+
+void ContinuousJog::setSegmentTime(int ms)
+{
+    m_segmentMs = qMax(10, ms);
+}
+
+void ContinuousJog::setMaxQueuedSegments(int segments)
+{
+    m_maxQueued = qMax(1, segments);
+}
+
+double ContinuousJog::segmentLength() const
+{
+    return m_feedrate / 60000.0 * m_segmentMs;
+}
+
+double ContinuousJog::maxStopDistance() const
+{
+    return segmentLength() * m_maxQueued;
+}
+
+void ContinuousJog::begin(double dirX, double dirY, double dirZ)
+{
+    const double length = std::sqrt(dirX * dirX + dirY * dirY + dirZ * dirZ);
+    if (length == 0.0)
+    {
+        end();
+        return;
+    }
+    if (!m_controller->isConnected())
+        return;
+
+    // A new direction applies from the next segment on
+    m_dirX = dirX / length;
+    m_dirY = dirY / length;
+    m_dirZ = dirZ / length;
+
+    if (m_active)
+        return;
+
+    m_active = true;
+    m_stopping = false;
+    m_stopTimer.stop();
+    if (!m_relative)
+    {
+        m_controller->enqueueLine("G91");
+        m_relative = true;
+    }
+
+    m_queuedUntilMs = m_clock.elapsed();
+    fill();
+    m_fillTimer.start(qMax(5, m_segmentMs / 2));
+}
+
+void ContinuousJog::end()
+{
+    if (!m_active)
+        return;
+
+    m_active = false;
+    m_fillTimer.stop();
+    if (m_relative && m_controller->isConnected())
+        m_controller->enqueueLine("G90");
+    m_relative = false;
+
+    // Measure how long the machine keeps moving; give up well after the
+    // estimated end of the queued motion if no position reports arrive
+    m_stopping = true;
+    m_releaseMs = m_clock.elapsed();
+    m_hasLastPos = false;
+    m_stopTimer.start(int(qMax<qint64>(0, m_queuedUntilMs - m_releaseMs)) + 1000);
+}
+
+void ContinuousJog::abort()
+{
+    m_active = false;
+    m_stopping = false;
+    m_fillTimer.stop();
+    m_stopTimer.stop();
+    m_outstanding.clear();
+    // M112 halts the firmware; it comes back from its reset in absolute mode
+    m_relative = false;
+}
+
+void ContinuousJog::fill()
+{
+    if (!m_active)
+        return;
+
+    const qint64 now = m_clock.elapsed();
+    const qint64 horizonMs = qint64(m_maxQueued) * m_segmentMs;
+    m_queuedUntilMs = qMax(m_queuedUntilMs, now);
+
+    const double length = segmentLength();
+    while (m_outstanding.size() < m_maxQueued && m_queuedUntilMs - now < horizonMs)
+    {
+        GCodeCommand cmd;
+        cmd.type = GCodeCommandType::Move;
+        cmd.x = m_dirX * length;
+        cmd.y = m_dirY * length;
+        cmd.z = m_dirZ * length;
+        cmd.feedrate = m_feedrate;
+
+        const quint64 id = m_controller->enqueueCommand(cmd);
+        if (id == 0)
+        {
+            end();
+            return;
+        }
+        m_outstanding.enqueue(id);
+        m_queuedUntilMs += m_segmentMs;
+    }
+}
+
+void ContinuousJog::onCommandFinished(quint64 id)
+{
+    // Acknowledgements arrive in send order
+    if (m_outstanding.isEmpty() || m_outstanding.head() != id)
+        return;
+    m_outstanding.dequeue();
+    if (m_active)
+        fill();
+}
+
+void ContinuousJog::onPositionUpdated(const MotorPosition &pos)
+{
+    if (!m_stopping)
+        return;
+
+    // Stopped once every segment is planned and two reports in a row agree
+    const bool unchanged = m_hasLastPos && pos.x == m_lastX && pos.y == m_lastY && pos.z == m_lastZ;
+    m_hasLastPos = true;
+    m_lastX = pos.x;
+    m_lastY = pos.y;
+    m_lastZ = pos.z;
+
+    if (unchanged && m_outstanding.isEmpty())
+        finishStop(m_clock.elapsed() - m_releaseMs);
+}
+
+void ContinuousJog::onStopTimeout()
+{
+    // No usable position reports; fall back to the estimated end of motion
+    if (m_stopping)
+        finishStop(qMax<qint64>(0, m_queuedUntilMs - m_releaseMs));
+}
+
+void ContinuousJog::finishStop(qint64 latencyMs)
+{
+    m_stopping = false;
+    m_stopTimer.stop();
+
+    m_lastStopMs = latencyMs;
+    m_maxStopMs = qMax(m_maxStopMs, latencyMs);
+    m_totalStopMs += latencyMs;
+    ++m_stopCount;
+    emit stopped(latencyMs);
+}
@@ -0,0 +1,88 @@
+// ContinuousJog.h
+#ifndef CONTINUOUSJOG_H
+#define CONTINUOUSJOG_H
+
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class TinyBeeController;
+struct MotorPosition;
+
+// Press-and-hold jogging. While active, short relative segments are streamed
+// ahead of the machine, but never more than maxQueuedSegments() worth of
+// motion: Marlin acknowledges a G1 as soon as it is planned, so besides
+// capping unacknowledged segments the amount still queued in the firmware is
+// estimated from the time each segment takes at the jog feedrate. After end()
+// the axis therefore travels at most maxStopDistance() (plus deceleration).
+class ContinuousJog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ContinuousJog(TinyBeeController *controller, QObject *parent = nullptr);
+
+    // Direction components are normalized; the path speed is feedrate()
+    void begin(double dirX, double dirY, double dirZ);
+    void end();
+    // After an emergency stop: forgets the jog without queuing anything (no
+    // G90) and without measuring a stop
+    void abort();
+    bool isActive() const { return m_active; }
+
+    void setFeedrate(int mmPerMin);
+    int feedrate() const { return m_feedrate; }
+    void setSegmentTime(int ms);
+    int segmentTime() const { return m_segmentMs; }
+    void setMaxQueuedSegments(int segments);
+    int maxQueuedSegments() const { return m_maxQueued; }
+
+    double segmentLength() const;   // mm per segment
+    double maxStopDistance() const; // mm travelled after end() at most, ignoring deceleration
+
+    // Stop latency: time from end() until the position stops changing
+    qint64 lastStopLatencyMs() const { return m_lastStopMs; }
+    qint64 maxStopLatencyMs() const { return m_maxStopMs; }
+    double averageStopLatencyMs() const { return m_stopCount ? double(m_totalStopMs) / m_stopCount : 0.0; }
+    int stopCount() const { return m_stopCount; }
+
+signals:
+    void stopped(qint64 latencyMs);
+
+private slots:
+    void fill();
+    void onCommandFinished(quint64 id);
+    void onPositionUpdated(const MotorPosition &pos);
+    void onStopTimeout();
+
+private:
+    TinyBeeController *m_controller;
+    QTimer m_fillTimer;
+    QTimer m_stopTimer;
+    QElapsedTimer m_clock;
+
+    bool m_active = false;
+    bool m_relative = false; // G91 sent and not yet undone
+    bool m_stopping = false;
+    double m_dirX = 0.0, m_dirY = 0.0, m_dirZ = 0.0;
+
+    int m_feedrate = 1000;
+    int m_segmentMs = 50;
+    int m_maxQueued = 4;
+
+    QQueue<quint64> m_outstanding; // Segment ids not yet acknowledged
+    qint64 m_queuedUntilMs = 0;    // Estimated time the planned motion runs out
+
+    qint64 m_releaseMs = 0;
+    bool m_hasLastPos = false;
+    double m_lastX = 0.0, m_lastY = 0.0, m_lastZ = 0.0;
+
+    qint64 m_lastStopMs = 0;
+    qint64 m_maxStopMs = 0;
+    qint64 m_totalStopMs = 0;
+    int m_stopCount = 0;
+
+    void finishStop(qint64 latencyMs);
+};
+
+#endif // CONTINUOUSJOG_H
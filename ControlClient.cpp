@@ -0,0 +1,167 @@
+// ControlClient.cpp
+#include "ControlClient.h"
+#include "ControlProtocol.h"
+#include <QLocalSocket>
+#include <QDebug>
+
+using namespace ControlProtocol;
+
+ControlClient::ControlClient(QObject *parent)
+    : QObject(parent), m_socket(new QLocalSocket(this))
+{
+    connect(m_socket, &QLocalSocket::readyRead, this, &ControlClient::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, &ControlClient::disconnected);
+}
+
+ControlClient::~ControlClient()
+{
+    m_socket->abort();
+}
+
+void ControlClient::connectToServer(const QString &name)
+{
+    m_rx.clear();
+    m_socket->connectToServer(name);
+}
+
+void ControlClient::disconnectFromServer()
+{
+    m_socket->disconnectFromServer();
+}
+
+bool ControlClient::isConnected() const
+{
+    return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+quint32 ControlClient::submitBatch(const QList<QByteArray> &lines, int timeoutMs)
+{
+    if (lines.isEmpty() || lines.size() > MaxBatchLines)
+        return 0;
+
+    int bytes = 0;
+    for (const QByteArray &line : lines)
+        bytes += 2 + line.size();
+
+    const quint32 tag = m_nextTag++;
+    FrameWriter batch(SubmitBatch, 10 + bytes);
+    batch.put(tag);
+    batch.put(quint32(qMax(0, timeoutMs)));
+    batch.put(quint16(lines.size()));
+    for (const QByteArray &line : lines)
+        batch.putString(line);
+    m_socket->write(batch.data());
+    return tag;
+}
+
+void ControlClient::subscribePositions(int minIntervalMs)
+{
+    FrameWriter subscribe(Subscribe, 4);
+    subscribe.put(quint32(qMax(0, minIntervalMs)));
+    m_socket->write(subscribe.data());
+}
+
+void ControlClient::unsubscribePositions()
+{
+    FrameWriter unsubscribe(Unsubscribe, 0);
+    m_socket->write(unsubscribe.data());
+}
+
+void ControlClient::onReadyRead()
+{
+    m_rx.append(m_socket->readAll());
+
+    int offset = 0;
+    for (;;)
+    {
+        const int size = frameSize(m_rx.constData() + offset, m_rx.size() - offset);
+        if (size == 0)
+            break;
+        if (size < 0 || !handleFrame(m_rx.constData() + offset + LengthSize, size - LengthSize))
+        {
+            emit errorOccurred("Malformed frame from control server");
+            m_socket->abort();
+            m_rx.clear();
+            return;
+        }
+        offset += size;
+    }
+    m_rx.remove(0, offset);
+}
+
+bool ControlClient::handleFrame(const char *payload, int size)
+{
+    FrameReader reader(payload, size);
+    quint8 type = 0;
+    reader.get(type);
+
+    switch (type)
+    {
+    case Hello:
+    {
+        quint16 version = 0;
+        quint8 board = 0;
+        if (!reader.get(version) || !reader.get(board))
+            return false;
+        if (version != Version)
+            qWarning() << "Control server speaks protocol version" << version << "- expected" << Version;
+        m_boardConnected = board != 0;
+        emit connected(m_boardConnected);
+        return true;
+    }
+    case BatchAccepted:
+    {
+        quint32 tag = 0;
+        quint16 count = 0;
+        if (!reader.get(tag) || !reader.get(count))
+            return false;
+        QVector<quint64> ids(count);
+        for (quint64 &id : ids)
+        {
+            if (!reader.get(id))
+                return false;
+        }
+        emit batchAccepted(tag, ids);
+        return true;
+    }
+    case Ack:
+    {
+        quint64 id = 0;
+        quint8 success = 0;
+        QByteArray text;
+        if (!reader.get(id) || !reader.get(success) || !reader.getString(text))
+            return false;
+        emit commandAcked(id, success != 0, QString::fromUtf8(text));
+        return true;
+    }
+    case Position:
+    {
+        MotorPosition pos;
+        if (!reader.get(pos.timestampNs) || !reader.get(pos.x) || !reader.get(pos.y) || !reader.get(pos.z) ||
+            !reader.get(pos.e))
+            return false;
+        emit positionReceived(pos);
+        return true;
+    }
+    case BoardState:
+    {
+        quint8 board = 0;
+        if (!reader.get(board))
+            return false;
+        m_boardConnected = board != 0;
+        emit boardStateChanged(m_boardConnected);
+        return true;
+    }
+    case Error:
+    {
+        QByteArray text;
+        if (!reader.getString(text))
+            return false;
+        emit errorOccurred(QString::fromUtf8(text));
+        return true;
+    }
+    default:
+        // Newer server; skip what this client does not know
+        return true;
+    }
+}
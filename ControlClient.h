@@ -0,0 +1,59 @@
+// ControlClient.h
+#ifndef CONTROLCLIENT_H
+#define CONTROLCLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include "TinybeeController.h"
+
+class QLocalSocket;
+
+// Client side of the ControlServer protocol, for processes that drive a board
+// owned by another process (vision, PLC bridges). Lines submitted together go
+// out in one frame; the server answers with their ids in batchAccepted() and
+// later one commandAcked() per id.
+class ControlClient : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ControlClient(QObject *parent = nullptr);
+    ~ControlClient();
+
+    void connectToServer(const QString &name);
+    void disconnectFromServer();
+    bool isConnected() const;
+    bool boardConnected() const { return m_boardConnected; }
+
+    // Returns the tag reported back with batchAccepted(); timeoutMs 0 uses the
+    // controller's default per-line timeout
+    quint32 submitBatch(const QList<QByteArray> &lines, int timeoutMs = 0);
+    quint32 submitLine(const QByteArray &line, int timeoutMs = 0) { return submitBatch({line}, timeoutMs); }
+
+    // At most one position per minIntervalMs (0 = every report)
+    void subscribePositions(int minIntervalMs = 0);
+    void unsubscribePositions();
+
+signals:
+    void connected(bool boardConnected);
+    void disconnected();
+    void boardStateChanged(bool boardConnected);
+    void batchAccepted(quint32 tag, const QVector<quint64> &ids); // 0 = line rejected
+    void commandAcked(quint64 id, bool success, const QString &response);
+    void positionReceived(const MotorPosition &pos);
+    void errorOccurred(const QString &error);
+
+private slots:
+    void onReadyRead();
+
+private:
+    QLocalSocket *m_socket;
+    QByteArray m_rx;
+    quint32 m_nextTag = 1;
+    bool m_boardConnected = false;
+
+    bool handleFrame(const char *payload, int size);
+};
+
+#endif // CONTROLCLIENT_H
@@ -0,0 +1,130 @@
+// ControlProtocol.h
+#ifndef CONTROLPROTOCOL_H
+#define CONTROLPROTOCOL_H
+
+#include <QByteArray>
+#include <cstring>
+
+// Binary protocol spoken over the ControlServer local socket. Every message is
+// one frame:
+//   length u32 (bytes after this field), type u8, payload
+// All integers are little endian; strings are a u16 byte count followed by
+// UTF-8 bytes. Client and server may pipeline any number of frames.
+//
+//   Client -> server
+//     SubmitBatch   tag u32, timeout_ms u32, count u16, count x line string
+//     Subscribe     min_interval_ms u32 (0 = every position report)
+//     Unsubscribe   -
+//   Server -> client
+//     Hello         version u16, board_connected u8 (sent on connect)
+//     BatchAccepted tag u32, count u16, count x id u64 (0 = line rejected)
+//     Ack           id u64, ok u8, response or error string
+//     Position      t_ns i64, x f64, y f64, z f64, e f64
+//     BoardState    board_connected u8
+//     Error         message string (protocol errors, the connection is closed after it)
+namespace ControlProtocol
+{
+constexpr quint16 Version = 1;
+constexpr int LengthSize = 4;
+constexpr int MaxFrameBytes = 1024 * 1024;
+constexpr int MaxBatchLines = 4096;
+
+enum MessageType : quint8
+{
+    SubmitBatch = 0x01,
+    Subscribe = 0x02,
+    Unsubscribe = 0x03,
+
+    Hello = 0x80,
+    BatchAccepted = 0x81,
+    Ack = 0x82,
+    Position = 0x83,
+    BoardState = 0x84,
+    Error = 0x85
+};
+
+// Size of the frame at the start of data including its length field, 0 if
+// more bytes are needed, -1 if the length is invalid
+inline int frameSize(const char *data, int available)
+{
+    if (available < LengthSize)
+        return 0;
+    quint32 length;
+    std::memcpy(&length, data, sizeof(length));
+    if (length == 0 || length > quint32(MaxFrameBytes))
+        return -1;
+    const int total = LengthSize + int(length);
+    return available >= total ? total : 0;
+}
+
+// Builds one frame; the length is filled in by data()
+class FrameWriter
+{
+public:
+    explicit FrameWriter(MessageType type, int reserve = 32)
+    {
+        m_data.reserve(LengthSize + 1 + reserve);
+        m_data.resize(LengthSize);
+        put(quint8(type));
+    }
+
+    template <typename T>
+    void put(T value)
+    {
+        m_data.append(reinterpret_cast<const char *>(&value), int(sizeof(T)));
+    }
+
+    void putString(const QByteArray &text)
+    {
+        const int size = int(qMin<qsizetype>(text.size(), 0xFFFF));
+        put(quint16(size));
+        m_data.append(text.constData(), size);
+    }
+
+    const QByteArray &data()
+    {
+        const quint32 length = quint32(m_data.size() - LengthSize);
+        std::memcpy(m_data.data(), &length, sizeof(length));
+        return m_data;
+    }
+
+private:
+    QByteArray m_data;
+};
+
+// Bounds-checked reads from the payload of one frame (after the length field)
+class FrameReader
+{
+public:
+    FrameReader(const char *data, int size) : m_data(data), m_size(size) {}
+
+    template <typename T>
+    bool get(T &value)
+    {
+        if (m_pos + int(sizeof(T)) > m_size)
+            return false;
+        std::memcpy(&value, m_data + m_pos, sizeof(T));
+        m_pos += int(sizeof(T));
+        return true;
+    }
+
+    bool getString(QByteArray &text)
+    {
+        quint16 size;
+        if (!get(size) || m_pos + int(size) > m_size)
+            return false;
+        text = QByteArray(m_data + m_pos, int(size));
+        m_pos += int(size);
+        return true;
+    }
+
+    bool atEnd() const { return m_pos == m_size; }
+
+private:
+    const char *m_data;
+    int m_size;
+    int m_pos = 0;
+};
+} // namespace ControlProtocol
+
+#endif // CONTROLPROTOCOL_H
@@ -0,0 +1,339 @@
+// ControlServer.cpp
+#include "ControlServer.h"
+#include "ControlProtocol.h"
+#include "LinkStatistics.h"
+#include "TinybeeController.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QVector>
+#include <QDebug>
+
+using namespace ControlProtocol;
+
+ControlServer::ControlServer(TinyBeeController *controller, QObject *parent)
+    : QObject(parent), m_controller(controller), m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+    connect(m_controller, &TinyBeeController::commandCompleted, this, &ControlServer::onCommandCompleted);
+    connect(m_controller, &TinyBeeController::commandFailed, this, &ControlServer::onCommandFailed);
+    connect(m_controller, &TinyBeeController::positionUpdated, this, &ControlServer::onPositionUpdated);
+    // connected is both a signal and a getter
+    connect(m_controller, static_cast<void (TinyBeeController::*)()>(&TinyBeeController::connected),
+            this, &ControlServer::onBoardStateChanged);
+    connect(m_controller, &TinyBeeController::disconnected, this, &ControlServer::onBoardStateChanged);
+}
+
+ControlServer::~ControlServer()
+{
+    close();
+}
+
+bool ControlServer::listen(const QString &name, QString *error)
+{
+    close();
+
+    // A previous instance that crashed leaves its socket file behind. Only a
+    // socket nobody answers on is stale; a running server keeps its name.
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(500))
+    {
+        probe.abort();
+        if (error)
+            *error = QString("%1 is already in use by a running server").arg(name);
+        qWarning() << "Control server failed to listen on" << name << ": already in use";
+        return false;
+    }
+    QLocalServer::removeServer(name);
+    if (!m_server->listen(name))
+    {
+        if (error)
+            *error = m_server->errorString();
+        qWarning() << "Control server failed to listen on" << name << ":" << m_server->errorString();
+        return false;
+    }
+
+    qInfo() << "Control server listening on" << m_server->fullServerName();
+    return true;
+}
+
+void ControlServer::close()
+{
+    m_server->close();
+    const QList<QLocalSocket *> sockets = m_clients.keys();
+    for (QLocalSocket *socket : sockets)
+    {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_clients.clear();
+    m_owners.clear();
+}
+
+bool ControlServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+QString ControlServer::serverName() const
+{
+    return m_server->fullServerName();
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection())
+    {
+        Client &client = m_clients[socket];
+        client.socket = socket;
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]()
+                { readClient(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]()
+                { dropClient(socket); });
+
+        FrameWriter hello(Hello);
+        hello.put(Version);
+        hello.put(quint8(m_controller->isConnected()));
+        send(client, hello.data());
+        emit clientConnected(m_clients.size());
+    }
+}
+
+void ControlServer::readClient(QLocalSocket *socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end() || it.value().closing)
+        return;
+
+    Client &client = it.value();
+    client.rx.append(socket->readAll());
+
+    // Frames are consumed in place and the buffer compacted once at the end
+    int offset = 0;
+    for (;;)
+    {
+        const int size = frameSize(client.rx.constData() + offset, client.rx.size() - offset);
+        if (size == 0)
+            break;
+        if (size < 0)
+        {
+            protocolError(client, "Invalid frame length");
+            return;
+        }
+        if (!handleFrame(client, client.rx.constData() + offset + LengthSize, size - LengthSize))
+            return;
+        offset += size;
+    }
+    client.rx.remove(0, offset);
+}
+
+bool ControlServer::handleFrame(Client &client, const char *payload, int size)
+{
+    FrameReader reader(payload, size);
+    quint8 type = 0;
+    reader.get(type);
+
+    switch (type)
+    {
+    case SubmitBatch:
+        return handleBatch(client, reader);
+    case Subscribe:
+    {
+        quint32 intervalMs = 0;
+        if (!reader.get(intervalMs) || !reader.atEnd())
+        {
+            protocolError(client, "Malformed Subscribe");
+            return false;
+        }
+        client.subscribed = true;
+        client.minIntervalNs = qint64(intervalMs) * 1000000;
+        client.lastPositionNs = 0;
+        return true;
+    }
+    case Unsubscribe:
+        client.subscribed = false;
+        return true;
+    default:
+        protocolError(client, QString("Unknown message type 0x%1").arg(type, 2, 16, QChar('0')));
+        return false;
+    }
+}
+
+bool ControlServer::handleBatch(Client &client, FrameReader &reader)
+{
+    quint32 tag = 0;
+    quint32 timeoutMs = 0;
+    quint16 count = 0;
+    if (!reader.get(tag) || !reader.get(timeoutMs) || !reader.get(count) || count > MaxBatchLines)
+    {
+        protocolError(client, "Malformed SubmitBatch");
+        return false;
+    }
+
+    // Parsed completely first, so a malformed batch queues nothing
+    QVector<QByteArray> lines(count);
+    for (QByteArray &line : lines)
+    {
+        if (!reader.getString(line))
+        {
+            protocolError(client, "Malformed SubmitBatch");
+            return false;
+        }
+    }
+    if (!reader.atEnd())
+    {
+        protocolError(client, "Malformed SubmitBatch");
+        return false;
+    }
+
+    const int timeout = timeoutMs > 0 ? int(qMin<quint32>(timeoutMs, 3600000)) : 2000;
+    FrameWriter reply(BatchAccepted, 6 + 8 * count);
+    reply.put(tag);
+    reply.put(count);
+    for (const QByteArray &line : lines)
+    {
+        // One line per entry; embedded newlines would desynchronise the acks
+        quint64 id = 0;
+        if (!line.contains('\n'))
+            id = m_controller->enqueueLine(line, timeout);
+        if (id != 0)
+            m_owners.insert(id, client.socket);
+        reply.put(id);
+    }
+
+    // Acks arrive from a later event-loop turn, so they always follow this
+    send(client, reply.data());
+    return true;
+}
+
+void ControlServer::onCommandCompleted(quint64 id, const QString &response)
+{
+    sendAck(id, true, response);
+}
+
+void ControlServer::onCommandFailed(quint64 id, const QString &error)
+{
+    sendAck(id, false, error);
+}
+
+void ControlServer::sendAck(quint64 id, bool success, const QString &text)
+{
+    QLocalSocket *socket = m_owners.take(id);
+    if (!socket)
+        return; // Not submitted through the server, or the client is gone
+
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end())
+        return;
+
+    const QByteArray utf8 = text.toUtf8();
+    FrameWriter ack(Ack, 11 + utf8.size());
+    ack.put(id);
+    ack.put(quint8(success));
+    ack.putString(utf8);
+    send(it.value(), ack.data());
+}
+
+void ControlServer::onPositionUpdated(const MotorPosition &pos)
+{
+    const qint64 t = pos.timestampNs ? pos.timestampNs : LinkStatistics::nowNs();
+    QByteArray frame; // Encoded on first use, shared by all subscribers
+
+    for (Client &client : m_clients)
+    {
+        if (!client.subscribed || client.closing)
+            continue;
+        if (client.minIntervalNs > 0 && client.lastPositionNs != 0 && t - client.lastPositionNs < client.minIntervalNs)
+            continue;
+        if (client.socket->bytesToWrite() > PositionBacklogBytes)
+        {
+            // The client is behind; a newer position will replace this one
+            ++m_positionsSkipped;
+            continue;
+        }
+
+        if (frame.isEmpty())
+        {
+            FrameWriter writer(Position, 40);
+            writer.put(t);
+            writer.put(pos.x);
+            writer.put(pos.y);
+            writer.put(pos.z);
+            writer.put(pos.e);
+            frame = writer.data();
+        }
+        send(client, frame);
+        client.lastPositionNs = t;
+    }
+}
+
+void ControlServer::onBoardStateChanged()
+{
+    FrameWriter state(BoardState, 1);
+    state.put(quint8(m_controller->isConnected()));
+    const QByteArray frame = state.data();
+    for (Client &client : m_clients)
+        send(client, frame);
+}
+
+void ControlServer::send(Client &client, const QByteArray &frame)
+{
+    if (client.closing)
+        return;
+
+    if (client.socket->bytesToWrite() + frame.size() > MaxBacklogBytes)
+    {
+        qWarning() << "Control client stopped reading; disconnecting it";
+        closeClient(client, false);
+        return;
+    }
+    client.socket->write(frame);
+}
+
+void ControlServer::protocolError(Client &client, const QString &message)
+{
+    qWarning() << "Control client protocol error:" << message;
+    FrameWriter error(Error);
+    error.putString(message.toUtf8());
+    send(client, error.data());
+    closeClient(client, true);
+}
+
+void ControlServer::closeClient(Client &client, bool flush)
+{
+    if (client.closing)
+        return;
+    client.closing = true;
+
+    // Deferred: callers still hold references into m_clients
+    QLocalSocket *socket = client.socket;
+    QMetaObject::invokeMethod(this, [this, socket, flush]()
+                              {
+        if (!m_clients.contains(socket))
+            return;
+        if (flush)
+            socket->disconnectFromServer(); // Sends what is queued, then disconnected()
+        else
+            socket->abort();
+        if (socket->state() == QLocalSocket::UnconnectedState)
+            dropClient(socket); }, Qt::QueuedConnection);
+}
+
+void ControlServer::dropClient(QLocalSocket *socket)
+{
+    if (m_clients.remove(socket) == 0)
+        return;
+
+    // Their commands still run; only the acks have nowhere to go
+    for (auto it = m_owners.begin(); it != m_owners.end();)
+    {
+        if (it.value() == socket)
+            it = m_owners.erase(it);
+        else
+            ++it;
+    }
+    socket->disconnect(this);
+    socket->deleteLater();
+    emit clientDisconnected(m_clients.size());
+}
@@ -0,0 +1,87 @@
+// ControlServer.h
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+
+class QLocalServer;
+class QLocalSocket;
+class TinyBeeController;
+struct MotorPosition;
+namespace ControlProtocol
+{
+class FrameReader;
+}
+
+// Local socket server (Unix domain socket / named pipe) in front of one
+// TinyBeeController, so several processes can drive a board that only one of
+// them could open. Clients submit batches of lines, get one id per line back
+// and an Ack per id when the board acknowledges it, and may subscribe to the
+// position stream at a rate of their choosing. See ControlProtocol.h for the
+// wire format.
+//
+// Commands from all clients share the controller's queue in arrival order.
+// Position frames are encoded once and written to every subscriber; a client
+// that stops reading has position frames skipped while its backlog exceeds
+// PositionBacklogBytes and is disconnected past MaxBacklogBytes, so one stuck
+// process cannot grow the server's memory.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ControlServer(TinyBeeController *controller, QObject *parent = nullptr);
+    ~ControlServer();
+
+    // Fails if another server is answering on name; a stale socket is replaced
+    bool listen(const QString &name, QString *error = nullptr);
+    void close();
+    bool isListening() const;
+    QString serverName() const;
+
+    int clientCount() const { return m_clients.size(); }
+    quint64 positionFramesSkipped() const { return m_positionsSkipped; }
+
+    static constexpr qint64 PositionBacklogBytes = 64 * 1024;
+    static constexpr qint64 MaxBacklogBytes = 4 * 1024 * 1024;
+
+signals:
+    void clientConnected(int clients);
+    void clientDisconnected(int clients);
+
+private slots:
+    void onNewConnection();
+    void onCommandCompleted(quint64 id, const QString &response);
+    void onCommandFailed(quint64 id, const QString &error);
+    void onPositionUpdated(const MotorPosition &pos);
+    void onBoardStateChanged();
+
+private:
+    struct Client
+    {
+        QLocalSocket *socket = nullptr;
+        QByteArray rx;
+        bool subscribed = false;
+        qint64 minIntervalNs = 0;
+        qint64 lastPositionNs = 0;
+        bool closing = false; // Removal is queued; nothing more is read or sent
+    };
+
+    TinyBeeController *m_controller;
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, Client> m_clients;
+    QHash<quint64, QLocalSocket *> m_owners; // Command id -> client that submitted it
+    quint64 m_positionsSkipped = 0;
+
+    void readClient(QLocalSocket *socket);
+    bool handleFrame(Client &client, const char *payload, int size);
+    bool handleBatch(Client &client, ControlProtocol::FrameReader &reader);
+    void sendAck(quint64 id, bool success, const QString &text);
+    void send(Client &client, const QByteArray &frame);
+    void protocolError(Client &client, const QString &message);
+    void closeClient(Client &client, bool flush);
+    void dropClient(QLocalSocket *socket);
+};
+
+#endif // CONTROLSERVER_H
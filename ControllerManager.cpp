@@ -0,0 +1,229 @@
+// ControllerManager.cpp
+#include "ControllerManager.h"
+#include <QDebug>
+
+ControllerManager::ControllerManager(int ioThreads, QObject *parent)
+    : QObject(parent)
+{
+    if (ioThreads <= 0)
+        ioThreads = qBound(1, QThread::idealThreadCount(), 4);
+
+    for (int i = 0; i < ioThreads; ++i)
+    {
+        std::unique_ptr<QThread> thread(new QThread);
+        thread->setObjectName(QString("TinyBee serial I/O %1").arg(i));
+        thread->start();
+        m_threads.push_back(std::move(thread));
+    }
+
+    m_statusTimer.setSingleShot(true);
+    m_statusTimer.setInterval(50);
+    connect(&m_statusTimer, &QTimer::timeout, this, &ControllerManager::statusChanged);
+}
+
+ControllerManager::~ControllerManager()
+{
+    // Controllers hand their workers back through the I/O threads, so they go first
+    m_devices.clear();
+    for (std::unique_ptr<QThread> &thread : m_threads)
+    {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+QThread *ControllerManager::leastLoadedThread() const
+{
+    QThread *best = m_threads.front().get();
+    int bestCount = -1;
+    for (const std::unique_ptr<QThread> &thread : m_threads)
+    {
+        int count = 0;
+        for (const std::unique_ptr<Device> &device : m_devices)
+        {
+            if (device->thread == thread.get())
+                ++count;
+        }
+        if (bestCount < 0 || count < bestCount)
+        {
+            best = thread.get();
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+int ControllerManager::addDevice(const QString &name, const QString &portName, qint32 baudRate)
+{
+    if (indexOf(name) >= 0)
+    {
+        qWarning() << "ControllerManager: device name already in use:" << name;
+        return -1;
+    }
+
+    std::unique_ptr<Device> device(new Device);
+    device->name = name;
+    device->portName = portName;
+    device->baudRate = baudRate;
+    device->thread = leastLoadedThread();
+    device->controller.reset(new TinyBeeController(SharedIoThread{device->thread}));
+
+    Device *d = device.get();
+    TinyBeeController *controller = d->controller.get();
+    connect(controller, &TinyBeeController::commandCompleted, this, [this, d](quint64, const QString &)
+            {
+        ++d->completed;
+        markDirty(); });
+    connect(controller, &TinyBeeController::commandFailed, this, [this, d](quint64, const QString &)
+            {
+        ++d->failed;
+        markDirty(); });
+    connect(controller, &TinyBeeController::positionUpdated, this, [this, d](const MotorPosition &pos)
+            {
+        d->position = pos;
+        d->hasPosition = true;
+        markDirty(); });
+    connect(controller, &TinyBeeController::errorOccurred, this, [this, d](const QString &error)
+            {
+        d->lastError = error;
+        markDirty();
+        for (int i = 0; i < deviceCount(); ++i)
+        {
+            if (m_devices[size_t(i)].get() == d)
+                emit deviceError(i, error);
+        } });
+    connect(controller, &TinyBeeController::disconnected, this, &ControllerManager::markDirty);
+    connect(controller, &TinyBeeController::queueEmpty, this, &ControllerManager::checkIdle);
+
+    m_devices.push_back(std::move(device));
+    markDirty();
+    return deviceCount() - 1;
+}
+
+void ControllerManager::removeDevice(int index)
+{
+    if (index < 0 || index >= deviceCount())
+        return;
+    m_devices.erase(m_devices.begin() + index);
+    markDirty();
+}
+
+int ControllerManager::indexOf(const QString &name) const
+{
+    for (int i = 0; i < deviceCount(); ++i)
+    {
+        if (m_devices[size_t(i)]->name == name)
+            return i;
+    }
+    return -1;
+}
+
+TinyBeeController *ControllerManager::controller(int index) const
+{
+    if (index < 0 || index >= deviceCount())
+        return nullptr;
+    return m_devices[size_t(index)]->controller.get();
+}
+
+int ControllerManager::connectAll()
+{
+    int connected = 0;
+    for (std::unique_ptr<Device> &device : m_devices)
+    {
+        if (device->controller->isConnected() || device->controller->connectPort(device->portName, device->baudRate))
+            ++connected;
+    }
+    markDirty();
+    return connected;
+}
+
+void ControllerManager::disconnectAll()
+{
+    for (std::unique_ptr<Device> &device : m_devices)
+    {
+        if (device->controller->isConnected())
+            device->controller->disconnectPort();
+    }
+}
+
+quint64 ControllerManager::enqueueLine(int index, const QByteArray &line, int timeoutMs)
+{
+    TinyBeeController *c = controller(index);
+    return c ? c->enqueueLine(line, timeoutMs) : 0;
+}
+
+quint64 ControllerManager::enqueueCommand(int index, const GCodeCommand &cmd, int timeoutMs)
+{
+    TinyBeeController *c = controller(index);
+    return c ? c->enqueueCommand(cmd, timeoutMs) : 0;
+}
+
+int ControllerManager::broadcastLine(const QByteArray &line, int timeoutMs)
+{
+    int accepted = 0;
+    for (std::unique_ptr<Device> &device : m_devices)
+    {
+        if (device->controller->isConnected() && device->controller->enqueueLine(line, timeoutMs) != 0)
+            ++accepted;
+    }
+    return accepted;
+}
+
+DeviceStatus ControllerManager::status(int index) const
+{
+    DeviceStatus status;
+    if (index < 0 || index >= deviceCount())
+        return status;
+
+    const Device &device = *m_devices[size_t(index)];
+    status.name = device.name;
+    status.portName = device.portName;
+    status.connected = device.controller->isConnected();
+    status.pending = device.controller->pendingCount();
+    status.inFlight = device.controller->inFlightCount();
+    status.completed = device.completed;
+    status.failed = device.failed;
+    status.position = device.position;
+    status.hasPosition = device.hasPosition;
+    status.lastError = device.lastError;
+    return status;
+}
+
+QVector<DeviceStatus> ControllerManager::statusAll() const
+{
+    QVector<DeviceStatus> all;
+    all.reserve(deviceCount());
+    for (int i = 0; i < deviceCount(); ++i)
+        all.append(status(i));
+    return all;
+}
+
+int ControllerManager::totalPending() const
+{
+    int pending = 0;
+    for (const std::unique_ptr<Device> &device : m_devices)
+        pending += device->controller->pendingCount();
+    return pending;
+}
+
+void ControllerManager::setStatusInterval(int ms)
+{
+    m_statusTimer.setInterval(qMax(0, ms));
+}
+
+void ControllerManager::markDirty()
+{
+    if (!m_statusTimer.isActive())
+        m_statusTimer.start();
+}
+
+void ControllerManager::checkIdle()
+{
+    markDirty();
+    for (const std::unique_ptr<Device> &device : m_devices)
+    {
+        if (device->controller->isConnected() && device->controller->pendingCount() > 0)
+            return;
+    }
+    emit allIdle();
+}
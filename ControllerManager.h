@@ -0,0 +1,95 @@
+// ControllerManager.h
+#ifndef CONTROLLERMANAGER_H
+#define CONTROLLERMANAGER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "TinybeeController.h"
+
+// Snapshot of one board for the combined status view
+struct DeviceStatus
+{
+    QString name;
+    QString portName;
+    bool connected = false;
+    int pending = 0;  // Queued + in-flight commands
+    int inFlight = 0; // Written, waiting for "ok"
+    quint64 completed = 0;
+    quint64 failed = 0;
+    MotorPosition position;
+    bool hasPosition = false;
+    QString lastError;
+};
+
+// Runs several TinyBee boards from one process. Every board keeps its own
+// TinyBeeController (command queue, send window, position updates), but the
+// serial workers are spread over a small fixed pool of I/O threads instead of
+// one thread per board, and all controllers live on the manager's thread.
+// Status changes from every board are merged into statusChanged(), emitted at
+// most once per status interval.
+class ControllerManager : public QObject
+{
+    Q_OBJECT
+public:
+    // ioThreads <= 0 picks min(QThread::idealThreadCount(), 4)
+    explicit ControllerManager(int ioThreads = 0, QObject *parent = nullptr);
+    ~ControllerManager();
+
+    // Returns the device index, or -1 if the name is already in use
+    int addDevice(const QString &name, const QString &portName, qint32 baudRate = 115200);
+    void removeDevice(int index);
+    int deviceCount() const { return int(m_devices.size()); }
+    int indexOf(const QString &name) const;
+    TinyBeeController *controller(int index) const;
+    int ioThreadCount() const { return int(m_threads.size()); }
+
+    // Returns the number of boards that connected
+    int connectAll();
+    void disconnectAll();
+
+    // Per-device command queues; ids are those of the device's controller
+    quint64 enqueueLine(int index, const QByteArray &line, int timeoutMs = 2000);
+    quint64 enqueueCommand(int index, const GCodeCommand &cmd, int timeoutMs = 2000);
+    // Same line to every connected board; returns how many accepted it
+    int broadcastLine(const QByteArray &line, int timeoutMs = 2000);
+
+    // Combined status view
+    DeviceStatus status(int index) const;
+    QVector<DeviceStatus> statusAll() const;
+    int totalPending() const;
+    void setStatusInterval(int ms);
+
+signals:
+    void statusChanged();
+    void deviceError(int index, const QString &error);
+    void allIdle(); // Every connected board has acknowledged all its commands
+
+private:
+    struct Device
+    {
+        QString name;
+        QString portName;
+        qint32 baudRate = 115200;
+        std::unique_ptr<TinyBeeController> controller;
+        QThread *thread = nullptr;
+        quint64 completed = 0;
+        quint64 failed = 0;
+        MotorPosition position;
+        bool hasPosition = false;
+        QString lastError;
+    };
+
+    std::vector<std::unique_ptr<QThread>> m_threads;
+    std::vector<std::unique_ptr<Device>> m_devices;
+    QTimer m_statusTimer;
+
+    QThread *leastLoadedThread() const;
+    void markDirty();
+    void checkIdle();
+};
+
+#endif // CONTROLLERMANAGER_H
@@ -0,0 +1,251 @@
+// GCodeFileStreamer.cpp
+#include "GCodeFileStreamer.h"
+#include "TinybeeController.h"
+#include <QDebug>
+#include <cstring>
+
+// --- GCodeLineTokenizer Implementation ---
+
+void GCodeLineTokenizer::reset(const char *data, qint64 size)
+{
+    m_data = data;
+    m_size = data ? size : 0;
+    m_offset = 0;
+    m_lineNumber = 0;
+}
+
+bool GCodeLineTokenizer::next(QByteArray &out)
+{
+    while (m_offset < m_size)
+    {
+        const char *begin = m_data + m_offset;
+        const char *newline = static_cast<const char *>(std::memchr(begin, '\n', size_t(m_size - m_offset)));
+        const char *end = newline ? newline : m_data + m_size;
+
+        m_offset = (end - m_data) + (newline ? 1 : 0);
+        ++m_lineNumber;
+
+        if (clean(begin, end, out))
+            return true;
+    }
+    return false;
+}
+
+bool GCodeLineTokenizer::clean(const char *begin, const char *end, QByteArray &out)
+{
+    out.resize(0);
+    out.reserve(int(end - begin));
+
+    bool inComment = false;
+    for (const char *p = begin; p < end; ++p)
+    {
+        char c = *p;
+        if (inComment)
+        {
+            if (c == ')')
+                inComment = false;
+            continue;
+        }
+        if (c == ';')
+            break;
+        if (c == '(')
+        {
+            inComment = true;
+            continue;
+        }
+
+        // Collapse runs of whitespace and drop leading whitespace
+        if (c == ' ' || c == '\t' || c == '\r')
+        {
+            if (!out.isEmpty() && !out.endsWith(' '))
+                out.append(' ');
+            continue;
+        }
+        out.append(c);
+    }
+
+    if (out.endsWith(' '))
+        out.chop(1);
+
+    return !out.isEmpty() && out != "%";
+}
+
+// --- GCodeFileStreamer Implementation ---
+
+GCodeFileStreamer::GCodeFileStreamer(TinyBeeController *controller, QObject *parent)
+    : QObject(parent), m_controller(controller)
+{
+    connect(m_controller, &TinyBeeController::commandCompleted, this, &GCodeFileStreamer::onCommandCompleted);
+    connect(m_controller, &TinyBeeController::commandFailed, this, &GCodeFileStreamer::onCommandFailed);
+}
+
+GCodeFileStreamer::~GCodeFileStreamer()
+{
+    closeFile();
+}
+
+bool GCodeFileStreamer::start(const QString &filePath)
+{
+    if (m_running)
+    {
+        qWarning() << "G-code job already running:" << m_file.fileName();
+        return false;
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        QString err = QString("Failed to open G-code file %1: %2").arg(filePath, m_file.errorString());
+        qWarning() << err;
+        emit failed(err);
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size > 0)
+    {
+        m_mapped = m_file.map(0, m_size);
+        if (!m_mapped)
+        {
+            QString err = QString("Failed to map G-code file %1: %2").arg(filePath, m_file.errorString());
+            qWarning() << err;
+            m_file.close();
+            emit failed(err);
+            return false;
+        }
+    }
+
+    m_tokenizer.reset(reinterpret_cast<const char *>(m_mapped), m_size);
+    m_outstanding.clear();
+    m_linesSent = 0;
+    m_linesCompleted = 0;
+    m_running = true;
+    m_paused = false;
+    m_inputDone = false;
+    m_progressTimer.start();
+
+    qInfo() << "Starting G-code job:" << filePath << "(" << m_size << "bytes )";
+    emit started(m_size);
+    feed();
+    return true;
+}
+
+void GCodeFileStreamer::pause()
+{
+    if (m_running)
+        m_paused = true;
+}
+
+void GCodeFileStreamer::resume()
+{
+    if (!m_running || !m_paused)
+        return;
+    m_paused = false;
+    feed();
+}
+
+void GCodeFileStreamer::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    m_outstanding.clear();
+    closeFile();
+    qInfo() << "G-code job stopped after" << m_linesSent << "lines";
+}
+
+void GCodeFileStreamer::setMaxQueued(int lines)
+{
+    m_maxQueued = qMax(1, lines);
+    if (m_running)
+        feed();
+}
+
+void GCodeFileStreamer::feed()
+{
+    while (m_running && !m_paused && !m_inputDone && m_outstanding.size() < m_maxQueued)
+    {
+        if (!m_tokenizer.next(m_line))
+        {
+            m_inputDone = true;
+            break;
+        }
+
+        quint64 id = m_controller->enqueueLine(m_line, m_lineTimeoutMs);
+        if (id == 0)
+        {
+            abortJob(QString("Controller rejected line %1: %2").arg(m_tokenizer.lineNumber()).arg(QString::fromUtf8(m_line)));
+            return;
+        }
+        m_outstanding.insert(id, m_tokenizer.lineNumber());
+        ++m_linesSent;
+    }
+
+    if (m_running && m_inputDone && m_outstanding.isEmpty())
+        finishJob();
+}
+
+void GCodeFileStreamer::onCommandCompleted(quint64 id, const QString &response)
+{
+    Q_UNUSED(response);
+    if (m_outstanding.remove(id) == 0)
+        return;
+
+    ++m_linesCompleted;
+    reportProgress(false);
+    feed();
+}
+
+void GCodeFileStreamer::onCommandFailed(quint64 id, const QString &error)
+{
+    auto it = m_outstanding.find(id);
+    if (it == m_outstanding.end())
+        return;
+
+    abortJob(QString("Line %1 failed: %2").arg(it.value()).arg(error));
+}
+
+void GCodeFileStreamer::reportProgress(bool force)
+{
+    // Progress is throttled so a fast stream does not flood the receivers
+    if (!force && m_progressTimer.elapsed() < 100)
+        return;
+    m_progressTimer.restart();
+    emit progress(bytesProcessed(), m_size, m_linesCompleted);
+}
+
+void GCodeFileStreamer::finishJob()
+{
+    m_running = false;
+    reportProgress(true);
+    closeFile();
+    qInfo() << "G-code job finished:" << m_linesCompleted << "lines";
+    emit finished();
+}
+
+void GCodeFileStreamer::abortJob(const QString &error)
+{
+    // The job's lines queued behind the failed one must not run on the
+    // machine after it has been reported as aborted. Only this job's: other
+    // users of the controller keep their commands.
+    m_running = false;
+    const QList<quint64> ids = m_outstanding.keys();
+    for (quint64 id : ids)
+        m_controller->cancelCommand(id);
+    m_outstanding.clear();
+    closeFile();
+    qWarning() << "G-code job aborted:" << error;
+    emit failed(error);
+}
+
+void GCodeFileStreamer::closeFile()
+{
+    if (m_mapped)
+    {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+}
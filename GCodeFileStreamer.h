@@ -0,0 +1,109 @@
+// GCodeFileStreamer.h
+#ifndef GCODEFILESTREAMER_H
+#define GCODEFILESTREAMER_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QElapsedTimer>
+
+class TinyBeeController;
+
+// Splits raw G-code text into sendable lines: strips ';' and '(...)' comments,
+// surrounding whitespace, blank lines and '%' program delimiters
+class GCodeLineTokenizer
+{
+public:
+    GCodeLineTokenizer() = default;
+    GCodeLineTokenizer(const char *data, qint64 size) { reset(data, size); }
+
+    void reset(const char *data, qint64 size);
+
+    // Writes the next non-empty line into out (without newline); false at end of input
+    bool next(QByteArray &out);
+
+    qint64 offset() const { return m_offset; }
+    qint64 lineNumber() const { return m_lineNumber; }
+
+    // Cleans a single raw line; returns false if nothing sendable remains
+    static bool clean(const char *begin, const char *end, QByteArray &out);
+
+private:
+    const char *m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_offset = 0;
+    qint64 m_lineNumber = 0; // Source lines consumed, including skipped ones
+};
+
+// Runs a G-code program from a file through TinyBeeController's send queue.
+// The file is memory-mapped and tokenized on demand, and only maxQueued()
+// lines are handed to the controller at a time, so memory use does not depend
+// on the size of the job.
+class GCodeFileStreamer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GCodeFileStreamer(TinyBeeController *controller, QObject *parent = nullptr);
+    ~GCodeFileStreamer();
+
+    bool start(const QString &filePath);
+    void pause();
+    void resume();
+    // Stops feeding new lines; lines already queued in the controller still
+    // complete. A failed line aborts the job and cancels the job's lines not
+    // yet written; those already sent to the firmware still run.
+    void stop();
+
+    bool isRunning() const { return m_running; }
+    bool isPaused() const { return m_paused; }
+
+    void setMaxQueued(int lines);
+    int maxQueued() const { return m_maxQueued; }
+    // Ack timeout per line. Marlin's busy: keepalive (every 2 s by default)
+    // restarts it during G28, G4 and full-planner waits, so it must be longer.
+    void setLineTimeout(int ms) { m_lineTimeoutMs = qMax(1, ms); }
+    int lineTimeout() const { return m_lineTimeoutMs; }
+
+    QString filePath() const { return m_file.fileName(); }
+    qint64 totalBytes() const { return m_size; }
+    qint64 bytesProcessed() const { return m_tokenizer.offset(); }
+    qint64 linesSent() const { return m_linesSent; }
+    qint64 linesCompleted() const { return m_linesCompleted; }
+
+signals:
+    void started(qint64 totalBytes);
+    void progress(qint64 bytesProcessed, qint64 totalBytes, qint64 linesCompleted);
+    void finished();
+    void failed(const QString &error);
+
+private slots:
+    void onCommandCompleted(quint64 id, const QString &response);
+    void onCommandFailed(quint64 id, const QString &error);
+
+private:
+    TinyBeeController *m_controller;
+    QFile m_file;
+    uchar *m_mapped = nullptr;
+    qint64 m_size = 0;
+    GCodeLineTokenizer m_tokenizer;
+    QByteArray m_line;
+
+    QHash<quint64, qint64> m_outstanding; // Controller id -> source line number, until acknowledged
+    int m_maxQueued = 32;
+    int m_lineTimeoutMs = 10000;
+    qint64 m_linesSent = 0;
+    qint64 m_linesCompleted = 0;
+    bool m_running = false;
+    bool m_paused = false;
+    bool m_inputDone = false;
+
+    QElapsedTimer m_progressTimer;
+
+    void feed();
+    void reportProgress(bool force);
+    void finishJob();
+    void abortJob(const QString &error);
+    void closeFile();
+};
+
+#endif // GCODEFILESTREAMER_H
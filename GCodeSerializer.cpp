@@ -0,0 +1,127 @@
+// GCodeSerializer.cpp
+#include "GCodeSerializer.h"
+#include "TinybeeController.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+const double kPow10[GCodeSerializer::MaxDecimals + 1] = {1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0};
+}
+
+GCodeSerializer::GCodeSerializer()
+{
+    m_buffer.resize(128);
+    for (int &decimals : m_precision)
+        decimals = 3;
+}
+
+void GCodeSerializer::setPrecision(Axis axis, int decimals)
+{
+    if (axis < 0 || axis >= AxisCount)
+        return;
+    m_precision[axis] = qBound(0, decimals, int(MaxDecimals));
+}
+
+char *GCodeSerializer::reserve(int bytes)
+{
+    if (m_size + bytes > int(m_buffer.size()))
+        m_buffer.resize(size_t(m_size + bytes) * 2);
+    return m_buffer.data() + m_size;
+}
+
+void GCodeSerializer::append(const char *text, int length)
+{
+    std::memcpy(reserve(length), text, size_t(length));
+    m_size += length;
+}
+
+void GCodeSerializer::append(char c)
+{
+    *reserve(1) = c;
+    ++m_size;
+}
+
+bool GCodeSerializer::appendNumber(double value, int decimals)
+{
+    if (!std::isfinite(value))
+        return false;
+
+    const double scale = kPow10[decimals];
+    double rounded = std::round(value * scale) / scale;
+    if (rounded == 0.0)
+        rounded = 0.0; // Never emit "-0"
+
+    // Fixed notation of a finite double fits in 32 bytes for any sane machine
+    // coordinate; fall back to the worst case (~310 digits) only if needed
+    char *first = reserve(32);
+    std::to_chars_result result = std::to_chars(first, first + 32, rounded, std::chars_format::fixed);
+    if (result.ec != std::errc())
+    {
+        first = reserve(400);
+        result = std::to_chars(first, first + 400, rounded, std::chars_format::fixed);
+        if (result.ec != std::errc())
+            return false;
+    }
+    m_size += int(result.ptr - first);
+    return true;
+}
+
+void GCodeSerializer::appendInt(int value)
+{
+    char *first = reserve(16);
+    std::to_chars_result result = std::to_chars(first, first + 16, value);
+    m_size += int(result.ptr - first);
+}
+
+bool GCodeSerializer::serialize(const GCodeCommand &cmd)
+{
+    m_size = 0;
+
+    switch (cmd.type)
+    {
+    case GCodeCommandType::FirmwareInfo:
+        append("M115", 4);
+        break;
+    case GCodeCommandType::Home:
+        append("G28", 3);
+        // Nonzero coordinates select the axes to home; none means all axes
+        if (cmd.x != 0)
+            append(" X", 2);
+        if (cmd.y != 0)
+            append(" Y", 2);
+        if (cmd.z != 0)
+            append(" Z", 2);
+        break;
+    case GCodeCommandType::Move:
+        append("G1 X", 4);
+        if (!appendNumber(cmd.x, m_precision[AxisX]))
+            return false;
+        append(" Y", 2);
+        if (!appendNumber(cmd.y, m_precision[AxisY]))
+            return false;
+        append(" Z", 2);
+        if (!appendNumber(cmd.z, m_precision[AxisZ]))
+            return false;
+        append(" F", 2);
+        appendInt(cmd.feedrate);
+        break;
+    case GCodeCommandType::EmergencyStop:
+        append("M112", 4);
+        break;
+    case GCodeCommandType::Custom:
+    {
+        QByteArray utf8 = cmd.customCommand.trimmed().toUtf8();
+        if (utf8.isEmpty())
+            return false;
+        append(utf8.constData(), int(utf8.size()));
+        break;
+    }
+    default:
+        return false;
+    }
+
+    append('\n');
+    return true;
+}
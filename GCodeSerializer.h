@@ -0,0 +1,53 @@
+// GCodeSerializer.h
+#ifndef GCODESERIALIZER_H
+#define GCODESERIALIZER_H
+
+#include <QByteArray>
+#include <vector>
+
+struct GCodeCommand;
+
+// Serializes GCodeCommand into a reusable byte buffer. Coordinates are rounded
+// to the configured number of decimals per axis and written with the shortest
+// representation that round-trips (std::to_chars), so "G1 X10 Y2.5" rather
+// than "G1 X10.000 Y2.500". After the first few commands no heap allocation
+// happens except for Custom commands, which need a UTF-8 conversion.
+class GCodeSerializer
+{
+public:
+    enum Axis
+    {
+        AxisX,
+        AxisY,
+        AxisZ,
+        AxisCount
+    };
+
+    GCodeSerializer();
+
+    void setPrecision(Axis axis, int decimals);
+    int precision(Axis axis) const { return m_precision[axis]; }
+
+    // Serializes cmd including the trailing '\n'. The result is valid until the
+    // next call; returns false for commands that cannot be written (NaN, empty)
+    bool serialize(const GCodeCommand &cmd);
+
+    const char *data() const { return m_buffer.data(); }
+    int size() const { return m_size; }
+    QByteArray toByteArray() const { return QByteArray(m_buffer.data(), m_size); }
+
+    static constexpr int MaxDecimals = 6;
+
+private:
+    std::vector<char> m_buffer;
+    int m_size = 0;
+    int m_precision[AxisCount];
+
+    void append(const char *text, int length);
+    void append(char c);
+    bool appendNumber(double value, int decimals);
+    void appendInt(int value);
+    char *reserve(int bytes);
+};
+
+#endif // GCODESERIALIZER_H
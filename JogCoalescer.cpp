@@ -0,0 +1,107 @@
+// JogCoalescer.cpp
+#include "JogCoalescer.h"
+#include "TinybeeController.h"
+#include <QDebug>
+
+JogCoalescer::JogCoalescer(TinyBeeController *controller, QObject *parent)
+    : QObject(parent), m_controller(controller)
+{
+    connect(m_controller, &TinyBeeController::commandCompleted, this, [this](quint64 id, const QString &)
+            { onCommandFinished(id); });
+    connect(m_controller, &TinyBeeController::commandFailed, this, [this](quint64 id, const QString &)
+            { onCommandFinished(id); });
+    connect(m_controller, &TinyBeeController::disconnected, this, [this]()
+            {
+        m_blockId = 0;
+        cancel(); });
+}
+
+int JogCoalescer::axisMask(double dx, double dy, double dz)
+{
+    return (dx != 0.0 ? 1 : 0) | (dy != 0.0 ? 2 : 0) | (dz != 0.0 ? 4 : 0);
+}
+
+void JogCoalescer::jog(double dx, double dy, double dz, int feedrate)
+{
+    const int axes = axisMask(dx, dy, dz);
+    if (axes == 0)
+        return;
+
+    if (!m_pending.isEmpty())
+    {
+        Segment &last = m_pending.last();
+        if (last.axes == axes && last.feedrate == feedrate)
+        {
+            last.dx += dx;
+            last.dy += dy;
+            last.dz += dz;
+            ++m_merged;
+            return;
+        }
+    }
+
+    Segment segment;
+    segment.dx = dx;
+    segment.dy = dy;
+    segment.dz = dz;
+    segment.feedrate = feedrate;
+    segment.axes = axes;
+    m_pending.append(segment);
+
+    if (m_blockId == 0)
+        dispatch();
+}
+
+void JogCoalescer::flush()
+{
+    if (!m_pending.isEmpty())
+        dispatch();
+}
+
+void JogCoalescer::cancel()
+{
+    m_pending.clear();
+}
+
+void JogCoalescer::onCommandFinished(quint64 id)
+{
+    if (id == 0 || id != m_blockId)
+        return;
+    m_blockId = 0;
+    if (!m_pending.isEmpty())
+        dispatch();
+}
+
+void JogCoalescer::dispatch()
+{
+    if (!m_controller->isConnected())
+    {
+        m_pending.clear();
+        return;
+    }
+
+    QStringList sent;
+    m_controller->enqueueLine("G91");
+    sent << "G91";
+
+    for (const Segment &segment : m_pending)
+    {
+        // Opposite clicks can cancel out completely
+        if (axisMask(segment.dx, segment.dy, segment.dz) == 0)
+            continue;
+
+        GCodeCommand cmd;
+        cmd.type = GCodeCommandType::Move;
+        cmd.x = segment.dx;
+        cmd.y = segment.dy;
+        cmd.z = segment.dz;
+        cmd.feedrate = segment.feedrate;
+        if (m_controller->enqueueCommand(cmd) != 0)
+            sent << QString::fromUtf8(m_controller->serializer().toByteArray().trimmed());
+    }
+    m_pending.clear();
+
+    m_blockId = m_controller->enqueueLine("G90");
+    sent << "G90";
+    emit jogSent(sent.join(" / "));
+}
@@ -0,0 +1,57 @@
+// JogCoalescer.h
+#ifndef JOGCOALESCER_H
+#define JOGCOALESCER_H
+
+#include <QObject>
+#include <QVector>
+
+class TinyBeeController;
+
+// Merges rapid relative jogs before they reach TinyBeeController. While one
+// jog block is being executed, further jogs are collected; consecutive jogs
+// over the same axes at the same feedrate are summed into a single segment.
+// When the running block is acknowledged everything collected goes out as one
+// "G91 / G1 ... / G90" block, so the total displacement is unchanged but the
+// mode switches and per-move acceleration ramps are paid only once.
+class JogCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JogCoalescer(TinyBeeController *controller, QObject *parent = nullptr);
+
+    void jog(double dx, double dy, double dz, int feedrate = 1000);
+
+    // Sends collected jogs now, even if a block is still running; call before
+    // any other command so jogs keep their place in the command order
+    void flush();
+    // Drops collected jogs that have not been sent
+    void cancel();
+
+    int pendingSegments() const { return m_pending.size(); }
+    quint64 mergedCount() const { return m_merged; }
+
+signals:
+    // Text of each dispatched block, for logging
+    void jogSent(const QString &commands);
+
+private slots:
+    void onCommandFinished(quint64 id);
+
+private:
+    struct Segment
+    {
+        double dx = 0.0, dy = 0.0, dz = 0.0;
+        int feedrate = 1000;
+        int axes = 0; // Bit mask of the axes this segment moves
+    };
+
+    TinyBeeController *m_controller;
+    QVector<Segment> m_pending;
+    quint64 m_blockId = 0; // Last command of the block in flight (0 = idle)
+    quint64 m_merged = 0;
+
+    void dispatch();
+    static int axisMask(double dx, double dy, double dz);
+};
+
+#endif // JOGCOALESCER_H
@@ -0,0 +1,80 @@
+// LatencyHistogram.cpp
+#include "LatencyHistogram.h"
+#include <algorithm>
+
+int LatencyHistogram::bucketFor(quint64 us)
+{
+    if (us < quint64(SubBuckets))
+        return int(us);
+
+    // Position of the highest set bit picks the power of two, the next
+    // SubBucketBits bits pick the linear bucket inside it
+    int exponent = 63;
+    while (!(us >> exponent))
+        --exponent;
+    if (exponent >= MaxExponent)
+        return BucketCount - 1;
+
+    const int shift = exponent - SubBucketBits;
+    const int sub = int(us >> shift) - SubBuckets;
+    return SubBuckets + shift * SubBuckets + sub;
+}
+
+quint64 LatencyHistogram::bucketUpperEdge(int bucket)
+{
+    if (bucket < SubBuckets)
+        return quint64(bucket);
+
+    const int shift = (bucket - SubBuckets) / SubBuckets;
+    const int sub = (bucket - SubBuckets) % SubBuckets;
+    return ((quint64(SubBuckets + sub + 1)) << shift) - 1;
+}
+
+void LatencyHistogram::record(quint64 us)
+{
+    ++m_buckets[size_t(bucketFor(us))];
+    m_min = m_count ? std::min(m_min, us) : us;
+    m_max = std::max(m_max, us);
+    m_sum += us;
+    ++m_count;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (other.m_count == 0)
+        return;
+    for (size_t i = 0; i < m_buckets.size(); ++i)
+        m_buckets[i] += other.m_buckets[i];
+    m_min = m_count ? std::min(m_min, other.m_min) : other.m_min;
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+quint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+
+    // Rank of the requested sample, 1-based
+    const double clamped = std::clamp(p, 0.0, 100.0);
+    const quint64 rank = std::max<quint64>(1, quint64(clamped / 100.0 * double(m_count) + 0.5));
+
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        seen += m_buckets[size_t(i)];
+        if (seen >= rank)
+            return i == BucketCount - 1 ? m_max : std::min(bucketUpperEdge(i), m_max);
+    }
+    return m_max;
+}
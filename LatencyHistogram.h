@@ -0,0 +1,44 @@
+// LatencyHistogram.h
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <array>
+
+// Fixed-size log-linear histogram of durations in microseconds. Every power
+// of two is split into 16 linear buckets, so any recorded value is known to
+// within 1/16 (about 6%) while the whole range from 1 us to days fits in a
+// few kilobytes. record() is a handful of integer operations and never
+// allocates; percentiles are read back by walking the buckets.
+class LatencyHistogram
+{
+public:
+    void record(quint64 us);
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    quint64 min() const { return m_count ? m_min : 0; }
+    quint64 max() const { return m_max; }
+    double mean() const { return m_count ? double(m_sum) / double(m_count) : 0.0; }
+
+    // Upper edge of the bucket holding the given percentile (0-100), capped at max()
+    quint64 percentile(double p) const;
+
+private:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int MaxExponent = 40; // Values up to 2^40 us (about 12 days)
+    static constexpr int BucketCount = SubBuckets + (MaxExponent - SubBucketBits) * SubBuckets;
+
+    static int bucketFor(quint64 us);
+    static quint64 bucketUpperEdge(int bucket);
+
+    std::array<quint64, BucketCount> m_buckets{};
+    quint64 m_count = 0;
+    quint64 m_sum = 0;
+    quint64 m_min = 0;
+    quint64 m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,119 @@
+// LineFramer.cpp
+#include "LineFramer.h"
+#include <cstring>
+
+namespace
+{
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+}
+
+LineFramer::LineFramer(int capacity)
+    : m_buffer(size_t(qMax(64, capacity)))
+{
+}
+
+void LineFramer::clear()
+{
+    m_head = m_scan = m_tail = 0;
+    m_discarding = false;
+}
+
+int LineFramer::makeRoom()
+{
+    if (m_head == m_tail)
+    {
+        m_head = m_scan = m_tail = 0;
+    }
+    else if (m_tail == capacity() && m_head > 0)
+    {
+        // Move the unfinished line to the front; complete lines were already consumed
+        int pending = m_tail - m_head;
+        std::memmove(m_buffer.data(), m_buffer.data() + m_head, size_t(pending));
+        m_scan -= m_head;
+        m_head = 0;
+        m_tail = pending;
+    }
+    else if (m_tail == capacity() && m_scan == m_tail)
+    {
+        // A single line fills the whole buffer: drop it and skip to the next '\n'
+        if (!m_discarding)
+            ++m_overflows;
+        m_discarding = true;
+        m_head = m_scan = m_tail = 0;
+    }
+    return capacity() - m_tail;
+}
+
+qint64 LineFramer::readFrom(QIODevice *device)
+{
+    qint64 total = 0;
+    for (;;)
+    {
+        int space = makeRoom();
+        if (space == 0)
+            break; // Complete lines are waiting to be consumed
+
+        qint64 n = device->read(m_buffer.data() + m_tail, space);
+        if (n <= 0)
+            break;
+        m_tail += int(n);
+        total += n;
+        if (n < space)
+            break;
+    }
+    return total;
+}
+
+int LineFramer::append(const char *data, int size)
+{
+    int accepted = 0;
+    while (accepted < size)
+    {
+        int space = makeRoom();
+        if (space == 0)
+            break;
+        int n = qMin(space, size - accepted);
+        std::memcpy(m_buffer.data() + m_tail, data + accepted, size_t(n));
+        m_tail += n;
+        accepted += n;
+    }
+    return accepted;
+}
+
+bool LineFramer::nextLine(std::string_view &line)
+{
+    while (m_scan < m_tail)
+    {
+        const char *base = m_buffer.data();
+        const char *newline = static_cast<const char *>(std::memchr(base + m_scan, '\n', size_t(m_tail - m_scan)));
+        if (!newline)
+        {
+            m_scan = m_tail;
+            return false;
+        }
+
+        int begin = m_head;
+        int end = int(newline - base);
+        m_head = m_scan = end + 1;
+
+        if (m_discarding)
+        {
+            m_discarding = false;
+            continue;
+        }
+
+        while (begin < end && isSpace(base[begin]))
+            ++begin;
+        while (end > begin && isSpace(base[end - 1]))
+            --end;
+        if (begin == end)
+            continue;
+
+        line = std::string_view(base + begin, size_t(end - begin));
+        return true;
+    }
+    return false;
+}
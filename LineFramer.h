@@ -0,0 +1,62 @@
+// LineFramer.h
+#ifndef LINEFRAMER_H
+#define LINEFRAMER_H
+
+#include <QIODevice>
+#include <string_view>
+#include <vector>
+
+// Splits a serial byte stream into lines. Data is read straight into a
+// fixed-capacity buffer whose space is recycled in place: consumed lines are
+// released and only the unfinished tail is moved back to the front when the
+// end is reached. Each byte is scanned for '\n' exactly once, and lines are
+// handed out as views into the buffer (without the terminator, surrounding
+// whitespace trimmed). A view stays valid until the next append()/readFrom().
+// Lines longer than the capacity are dropped and counted in overflowCount().
+class LineFramer
+{
+public:
+    explicit LineFramer(int capacity = 4096);
+
+    // Reads as much as fits from device; returns bytes read
+    qint64 readFrom(QIODevice *device);
+    // Copies data in; returns bytes accepted (less than size when full)
+    int append(const char *data, int size);
+
+    bool nextLine(std::string_view &line);
+
+    // Drains device completely, invoking onLine for every complete line
+    template <typename Fn>
+    int readLines(QIODevice *device, Fn &&onLine)
+    {
+        int lines = 0;
+        std::string_view line;
+        do
+        {
+            readFrom(device);
+            while (nextLine(line))
+            {
+                onLine(line);
+                ++lines;
+            }
+        } while (device->bytesAvailable() > 0);
+        return lines;
+    }
+
+    void clear();
+    int capacity() const { return int(m_buffer.size()); }
+    int buffered() const { return m_tail - m_head; }
+    quint64 overflowCount() const { return m_overflows; }
+
+private:
+    std::vector<char> m_buffer;
+    int m_head = 0; // Start of the first unconsumed line
+    int m_scan = 0; // Bytes before this offset contain no '\n' past m_head
+    int m_tail = 0; // End of valid data
+    bool m_discarding = false;
+    quint64 m_overflows = 0;
+
+    int makeRoom();
+};
+
+#endif // LINEFRAMER_H
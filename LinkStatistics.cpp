@@ -0,0 +1,159 @@
+// LinkStatistics.cpp
+#include "LinkStatistics.h"
+#include <QStringList>
+#include <chrono>
+
+namespace
+{
+QString formatUs(quint64 us)
+{
+    if (us >= 10000000)
+        return QString("%1 s").arg(us / 1e6, 0, 'f', 1);
+    if (us >= 10000)
+        return QString("%1 ms").arg(us / 1e3, 0, 'f', 1);
+    return QString("%1 us").arg(us);
+}
+
+QString histogramLine(const char *label, const LatencyHistogram &h)
+{
+    return QString("    %1 p50 %2  p99 %3  max %4")
+        .arg(QString(label).leftJustified(10))
+        .arg(formatUs(h.percentile(50)), -9)
+        .arg(formatUs(h.percentile(99)), -9)
+        .arg(formatUs(h.max()));
+}
+} // namespace
+
+qint64 LinkStatistics::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+LinkStatistics::Kind LinkStatistics::classify(const QByteArray &line)
+{
+    // Only the command word matters: "G1 X10", "G0X5", "M114"
+    int end = 1;
+    while (end < line.size() && line[end] >= '0' && line[end] <= '9')
+        ++end;
+    const QByteArray code = line.left(end);
+    if (code == "G0" || code == "G1")
+        return Motion;
+    if (code == "G28")
+        return Homing;
+    if (code == "M114")
+        return PositionQuery;
+    return Other;
+}
+
+const char *LinkStatistics::kindName(Kind kind)
+{
+    switch (kind)
+    {
+    case Motion:
+        return "motion";
+    case Homing:
+        return "homing";
+    case PositionQuery:
+        return "M114";
+    default:
+        return "other";
+    }
+}
+
+void LinkStatistics::reset()
+{
+    *this = LinkStatistics();
+    startNs = nowNs();
+}
+
+void LinkStatistics::recordAck(Kind kind, qint64 queuedNs, qint64 writtenNs, qint64 ackedNs, bool success)
+{
+    KindStats &stats = kinds[kind];
+    if (!success)
+    {
+        ++stats.failed;
+        return;
+    }
+    ++stats.completed;
+    stats.queueWait.record(quint64(qMax<qint64>(0, writtenNs - queuedNs) / 1000));
+    stats.roundTrip.record(quint64(qMax<qint64>(0, ackedNs - writtenNs) / 1000));
+    stats.total.record(quint64(qMax<qint64>(0, ackedNs - queuedNs) / 1000));
+}
+
+LinkStatistics::KindStats LinkStatistics::combined() const
+{
+    KindStats all;
+    for (const KindStats &stats : kinds)
+    {
+        all.queueWait.merge(stats.queueWait);
+        all.roundTrip.merge(stats.roundTrip);
+        all.total.merge(stats.total);
+        all.completed += stats.completed;
+        all.failed += stats.failed;
+    }
+    return all;
+}
+
+quint64 LinkStatistics::commandCount() const
+{
+    quint64 count = 0;
+    for (const KindStats &stats : kinds)
+        count += stats.completed;
+    return count;
+}
+
+double LinkStatistics::elapsedSeconds() const
+{
+    return startNs ? double(nowNs() - startNs) / 1e9 : 0.0;
+}
+
+double LinkStatistics::commandsPerSecond() const
+{
+    const double seconds = elapsedSeconds();
+    return seconds > 0.0 ? double(commandCount()) / seconds : 0.0;
+}
+
+double LinkStatistics::bytesWrittenPerSecond() const
+{
+    const double seconds = elapsedSeconds();
+    return seconds > 0.0 ? double(bytesWritten) / seconds : 0.0;
+}
+
+double LinkStatistics::bytesReceivedPerSecond() const
+{
+    const double seconds = elapsedSeconds();
+    return seconds > 0.0 ? double(bytesReceived) / seconds : 0.0;
+}
+
+QString LinkStatistics::toText() const
+{
+    QStringList lines;
+    lines << QString("Link statistics over %1 s").arg(elapsedSeconds(), 0, 'f', 1);
+    lines << QString("  commands  %1 ok, %2 failed, %3/s")
+                 .arg(commandCount())
+                 .arg(combined().failed)
+                 .arg(commandsPerSecond(), 0, 'f', 1);
+    lines << QString("  tx        %1 bytes, %2 B/s").arg(bytesWritten).arg(bytesWrittenPerSecond(), 0, 'f', 0);
+    lines << QString("  rx        %1 bytes in %2 lines, %3 B/s")
+                 .arg(bytesReceived)
+                 .arg(linesReceived)
+                 .arg(bytesReceivedPerSecond(), 0, 'f', 0);
+    if (resendRequests > 0)
+        lines << QString("  resends   %1 requested, %2 lines resent").arg(resendRequests).arg(linesResent);
+    if (emergencyStop.count() > 0)
+        lines << histogramLine("e-stop", emergencyStop);
+
+    for (int k = 0; k < KindCount; ++k)
+    {
+        const KindStats &stats = kinds[k];
+        if (stats.completed == 0 && stats.failed == 0)
+            continue;
+        lines << QString("  %1 (%2 ok, %3 failed)").arg(kindName(Kind(k))).arg(stats.completed).arg(stats.failed);
+        lines << histogramLine("queued", stats.queueWait);
+        lines << histogramLine("ack rtt", stats.roundTrip);
+        lines << histogramLine("total", stats.total);
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,66 @@
+// LinkStatistics.h
+#ifndef LINKSTATISTICS_H
+#define LINKSTATISTICS_H
+
+#include <QByteArray>
+#include <QString>
+#include "LatencyHistogram.h"
+
+// Per-command timing and throughput of one serial link. Each command is
+// stamped when it is queued (enqueueCommand/enqueueLine), when it is handed to
+// the port and when its acknowledgement arrives; the three intervals are kept
+// per command kind. Recorded on the I/O thread, read as a copy through
+// TinyBeeController::linkStatistics().
+struct LinkStatistics
+{
+    enum Kind
+    {
+        Motion,        // G0/G1
+        Homing,        // G28
+        PositionQuery, // M114
+        Other,
+        KindCount
+    };
+
+    struct KindStats
+    {
+        LatencyHistogram queueWait; // Queued -> written
+        LatencyHistogram roundTrip; // Written -> acknowledged
+        LatencyHistogram total;     // Queued -> acknowledged
+        quint64 completed = 0;
+        quint64 failed = 0;
+    };
+
+    KindStats kinds[KindCount];
+    quint64 bytesWritten = 0;
+    quint64 bytesReceived = 0;
+    quint64 linesReceived = 0;
+    quint64 resendRequests = 0; // Firmware resend requests acted on
+    quint64 linesResent = 0;
+    LatencyHistogram emergencyStop; // Stop requested -> M112 handed to the driver
+    qint64 startNs = 0; // Clock value at the last reset
+
+    static qint64 nowNs(); // Monotonic clock shared by both threads
+    static Kind classify(const QByteArray &line);
+    static const char *kindName(Kind kind);
+
+    void reset();
+    void recordAck(Kind kind, qint64 queuedNs, qint64 writtenNs, qint64 ackedNs, bool success);
+    // Failed without an ack (cancelled, disconnected, never written); no latency
+    void recordFailure(Kind kind) { ++kinds[kind].failed; }
+
+    // All kinds combined
+    KindStats combined() const;
+    quint64 commandCount() const;
+
+    // Rates since the last reset
+    double elapsedSeconds() const;
+    double commandsPerSecond() const;
+    double bytesWrittenPerSecond() const;
+    double bytesReceivedPerSecond() const;
+
+    // Multi-line summary: rates, then p50/p99/max per kind and interval
+    QString toText() const;
+};
+
+#endif // LINKSTATISTICS_H
@@ -0,0 +1,369 @@
+// MotionPlanner.cpp
+#include "MotionPlanner.h"
+#include "TinybeeController.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+// Speeds are never planned to exactly zero in the middle of a path
+constexpr double MinimumSpeed = 0.05; // mm/s
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+} // namespace
+
+void MotionPlanner::setStartPosition(double x, double y, double z)
+{
+    m_endX = x;
+    m_endY = y;
+    m_endZ = z;
+}
+
+void MotionPlanner::clear()
+{
+    m_unitX.clear();
+    m_unitY.clear();
+    m_unitZ.clear();
+    m_length.clear();
+    m_cruise.clear();
+    m_accel.clear();
+    m_entry.clear();
+    m_peak.clear();
+    m_time.clear();
+    m_timeAfter.clear();
+}
+
+void MotionPlanner::reserve(int segments)
+{
+    const size_t n = size_t(std::max(0, segments));
+    for (std::vector<double> *v : {&m_unitX, &m_unitY, &m_unitZ, &m_length, &m_cruise, &m_accel,
+                                   &m_entry, &m_peak, &m_time, &m_timeAfter})
+        v->reserve(n);
+}
+
+double MotionPlanner::maxFeedrate(double dx, double dy, double dz) const
+{
+    const double length = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (length <= 0.0)
+        return 0.0;
+
+    const double d[3] = {dx, dy, dz};
+    double cruise = HUGE_VAL;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const double component = std::fabs(d[axis]) / length;
+        if (component > 0.0)
+            cruise = std::min(cruise, m_limits.maxVelocity[axis] / component);
+    }
+    return cruise * 60.0;
+}
+
+void MotionPlanner::addMove(double x, double y, double z, double feedrate)
+{
+    const double dx = x - m_endX;
+    const double dy = y - m_endY;
+    const double dz = z - m_endZ;
+    const double length = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (length < 1e-9)
+        return;
+
+    m_endX = x;
+    m_endY = y;
+    m_endZ = z;
+
+    // Velocity and acceleration along the path are limited by every axis that moves
+    const double unit[3] = {dx / length, dy / length, dz / length};
+    double cruise = feedrate > 0.0 ? feedrate / 60.0 : HUGE_VAL;
+    double accel = HUGE_VAL;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const double component = std::fabs(unit[axis]);
+        if (component > 0.0)
+        {
+            cruise = std::min(cruise, m_limits.maxVelocity[axis] / component);
+            accel = std::min(accel, m_limits.maxAcceleration[axis] / component);
+        }
+    }
+
+    m_unitX.push_back(unit[0]);
+    m_unitY.push_back(unit[1]);
+    m_unitZ.push_back(unit[2]);
+    m_length.push_back(length);
+    m_cruise.push_back(cruise);
+    m_accel.push_back(accel);
+    m_entry.push_back(0.0);
+    m_peak.push_back(0.0);
+    m_time.push_back(0.0);
+    m_timeAfter.push_back(0.0);
+}
+
+bool MotionPlanner::addMove(const GCodeCommand &cmd)
+{
+    if (cmd.type != GCodeCommandType::Move)
+        return false;
+    addMove(cmd.x, cmd.y, cmd.z, double(cmd.feedrate));
+    return true;
+}
+
+void MotionPlanner::plan()
+{
+    const size_t n = m_length.size();
+    if (n == 0)
+        return;
+
+    const double *ux = m_unitX.data();
+    const double *uy = m_unitY.data();
+    const double *uz = m_unitZ.data();
+    const double *length = m_length.data();
+    const double *cruise = m_cruise.data();
+    const double *accel = m_accel.data();
+    double *entry = m_entry.data();
+    double *peak = m_peak.data();
+    double *time = m_time.data();
+    double *timeAfter = m_timeAfter.data();
+
+    // Junction speeds (Marlin's junction deviation model); stored as the entry limit
+    entry[0] = std::min(std::max(0.0, m_startSpeed), cruise[0]);
+    const double deviation = m_limits.junctionDeviation;
+    for (size_t i = 1; i < n; ++i)
+    {
+        const double cosTheta = -(ux[i - 1] * ux[i] + uy[i - 1] * uy[i] + uz[i - 1] * uz[i]);
+        const double limit = std::min(cruise[i - 1], cruise[i]);
+        double junction;
+        if (cosTheta > 0.999999)
+        {
+            junction = MinimumSpeed; // Full reversal
+        }
+        else if (cosTheta < -0.999999)
+        {
+            junction = limit; // Straight continuation
+        }
+        else
+        {
+            const double sinHalf = std::sqrt(0.5 * (1.0 - cosTheta));
+            junction = std::sqrt(accel[i] * deviation * sinHalf / (1.0 - sinHalf));
+        }
+        entry[i] = std::max(MinimumSpeed, std::min(junction, limit));
+    }
+
+    // Backward pass: every segment must be able to slow down to the next entry (0 at the end)
+    double exitSpeed = 0.0;
+    for (size_t i = n; i-- > 0;)
+    {
+        const double reachable = std::sqrt(exitSpeed * exitSpeed + 2.0 * accel[i] * length[i]);
+        entry[i] = std::min(entry[i], reachable);
+        exitSpeed = entry[i];
+    }
+
+    // Forward pass: entries cannot exceed what the previous segment accelerates to
+    for (size_t i = 1; i < n; ++i)
+    {
+        const double reachable = std::sqrt(entry[i - 1] * entry[i - 1] + 2.0 * accel[i - 1] * length[i - 1]);
+        entry[i] = std::min(entry[i], reachable);
+    }
+
+    // Timing per segment, then suffix sums for remaining-time queries
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double exit = i + 1 < n ? entry[i + 1] : 0.0;
+        time[i] = segmentTiming(entry[i], exit, cruise[i], accel[i], length[i], peak[i]);
+    }
+
+    double after = 0.0;
+    for (size_t i = n; i-- > 0;)
+    {
+        timeAfter[i] = after;
+        after += time[i];
+    }
+}
+
+double MotionPlanner::speedChangeTime(double v0, double v1, double accel) const
+{
+    const double dv = std::fabs(v1 - v0);
+    if (m_profile == Trapezoidal)
+        return dv / accel;
+
+    // Jerk-limited: ramp up to full acceleration and back down, or a pure
+    // jerk ramp when the speed change is too small to reach it
+    const double jerk = m_limits.maxJerk;
+    if (dv >= accel * accel / jerk)
+        return dv / accel + accel / jerk;
+    return 2.0 * std::sqrt(dv / jerk);
+}
+
+double MotionPlanner::segmentTiming(double v0, double v1, double cruise, double accel, double length, double &peak) const
+{
+    // Both ramp shapes are symmetric, so a speed change covers (v0 + v1) / 2 * t
+    auto rampDistance = [&](double from, double to)
+    {
+        return 0.5 * (from + to) * speedChangeTime(from, to, accel);
+    };
+
+    const double top = std::max(cruise, std::max(v0, v1));
+    const double accelDistance = rampDistance(v0, top);
+    const double decelDistance = rampDistance(top, v1);
+    if (accelDistance + decelDistance <= length)
+    {
+        peak = top;
+        return speedChangeTime(v0, top, accel) + speedChangeTime(top, v1, accel) +
+               (length - accelDistance - decelDistance) / top;
+    }
+
+    double vp;
+    if (m_profile == Trapezoidal)
+    {
+        // Closed form for the triangle profile
+        vp = std::sqrt(0.5 * (2.0 * accel * length + v0 * v0 + v1 * v1));
+    }
+    else
+    {
+        // Ramp distance grows monotonically with the peak speed; bisect for it
+        double lo = std::max(v0, v1);
+        double hi = top;
+        for (int iter = 0; iter < 40 && hi - lo > 1e-6; ++iter)
+        {
+            const double mid = 0.5 * (lo + hi);
+            if (rampDistance(v0, mid) + rampDistance(mid, v1) > length)
+                hi = mid;
+            else
+                lo = mid;
+        }
+        vp = lo;
+    }
+
+    vp = std::max(vp, std::max(v0, v1));
+    peak = vp;
+    const double rampTime = speedChangeTime(v0, vp, accel) + speedChangeTime(vp, v1, accel);
+    const double rampLength = rampDistance(v0, vp) + rampDistance(vp, v1);
+    return rampTime + std::max(0.0, length - rampLength) / std::max(vp, MinimumSpeed);
+}
+
+double MotionPlanner::totalTime() const
+{
+    if (m_time.empty())
+        return 0.0;
+    return m_time.front() + m_timeAfter.front();
+}
+
+double MotionPlanner::remainingTime(int segment, double fraction) const
+{
+    if (segment < 0)
+        return totalTime();
+    if (segment >= segmentCount())
+        return 0.0;
+    const size_t i = size_t(segment);
+    return m_time[i] * (1.0 - std::clamp(fraction, 0.0, 1.0)) + m_timeAfter[i];
+}
+
+double MotionPlanner::distanceAt(int segment, double t, double *speed) const
+{
+    if (segment < 0 || segment >= segmentCount())
+    {
+        if (speed)
+            *speed = 0.0;
+        return 0.0;
+    }
+
+    const size_t i = size_t(segment);
+    const double v0 = m_entry[i];
+    const double v1 = i + 1 < m_entry.size() ? m_entry[i + 1] : 0.0;
+    const double vp = m_peak[i];
+    const double accelTime = speedChangeTime(v0, vp, m_accel[i]);
+    const double decelTime = speedChangeTime(vp, v1, m_accel[i]);
+    const double cruiseTime = std::max(0.0, m_time[i] - accelTime - decelTime);
+    t = std::clamp(t, 0.0, m_time[i]);
+
+    double v;
+    double distance;
+    if (t < accelTime)
+    {
+        v = v0 + (vp - v0) * t / accelTime;
+        distance = 0.5 * (v0 + v) * t;
+    }
+    else if (t < accelTime + cruiseTime)
+    {
+        v = vp;
+        distance = 0.5 * (v0 + vp) * accelTime + vp * (t - accelTime);
+    }
+    else
+    {
+        const double td = t - accelTime - cruiseTime;
+        v = decelTime > 0.0 ? vp + (v1 - vp) * std::min(1.0, td / decelTime) : v1;
+        distance = 0.5 * (v0 + vp) * accelTime + vp * cruiseTime + 0.5 * (vp + v) * td;
+    }
+
+    if (speed)
+        *speed = v;
+    return std::min(distance, m_length[i]);
+}
+
+double MotionPlanner::timeAt(int segment, double distance) const
+{
+    if (segment < 0 || segment >= segmentCount())
+        return 0.0;
+
+    // distanceAt() is monotonic in t
+    double lo = 0.0;
+    double hi = m_time[size_t(segment)];
+    for (int iter = 0; iter < 40 && hi - lo > 1e-7; ++iter)
+    {
+        const double mid = 0.5 * (lo + hi);
+        if (distanceAt(segment, mid) < distance)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+bool MotionPlanner::parseLimitsReport(std::string_view line, MotionLimits &limits)
+{
+    double *target = nullptr;
+    size_t pos = line.find("M203");
+    if (pos != std::string_view::npos)
+    {
+        target = limits.maxVelocity;
+    }
+    else if ((pos = line.find("M201")) != std::string_view::npos)
+    {
+        target = limits.maxAcceleration;
+    }
+    else
+    {
+        return false;
+    }
+
+    const char *p = line.data() + pos + 4;
+    const char *end = line.data() + line.size();
+    bool found = false;
+    while (p < end)
+    {
+        while (p < end && isSpace(*p))
+            ++p;
+        if (p >= end)
+            break;
+
+        const char letter = *p++;
+        double value = 0.0;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+        {
+            while (p < end && !isSpace(*p))
+                ++p;
+            continue;
+        }
+        p = result.ptr;
+
+        const int axis = letter == 'X' ? 0 : letter == 'Y' ? 1 : letter == 'Z' ? 2 : -1;
+        if (axis >= 0 && value > 0.0)
+        {
+            target[axis] = value;
+            found = true;
+        }
+    }
+    return found;
+}
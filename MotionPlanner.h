@@ -0,0 +1,100 @@
+// MotionPlanner.h
+#ifndef MOTIONPLANNER_H
+#define MOTIONPLANNER_H
+
+#include <string_view>
+#include <vector>
+
+struct GCodeCommand;
+
+// Machine limits per axis (X, Y, Z), in Marlin's units
+struct MotionLimits
+{
+    double maxVelocity[3] = {300.0, 300.0, 5.0};         // mm/s (M203)
+    double maxAcceleration[3] = {3000.0, 3000.0, 100.0}; // mm/s^2 (M201)
+    double junctionDeviation = 0.013;                    // mm
+    double maxJerk = 100000.0;                           // mm/s^3, S-curve profile only
+};
+
+// Host-side lookahead planner. Moves are appended to a structure-of-arrays
+// segment buffer (one contiguous array per quantity), then plan() runs the
+// junction-speed, backward and forward passes and the per-segment timing as
+// straight loops over those arrays. The result gives the feedrate each move
+// can actually reach and the time to execute the remaining moves.
+class MotionPlanner
+{
+public:
+    enum Profile
+    {
+        Trapezoidal, // Constant acceleration
+        SCurve       // Jerk-limited acceleration
+    };
+
+    MotionPlanner() = default;
+
+    void setLimits(const MotionLimits &limits) { m_limits = limits; }
+    const MotionLimits &limits() const { return m_limits; }
+    void setProfile(Profile profile) { m_profile = profile; }
+    Profile profile() const { return m_profile; }
+
+    // Moves start from here; cleared segments keep the last end position
+    void setStartPosition(double x, double y, double z);
+    // Speed (mm/s) entering the first move, for replanning a path that is
+    // already under way; 0 (the default) starts from rest
+    void setStartSpeed(double speed) { m_startSpeed = speed; }
+    void clear();
+    void reserve(int segments);
+
+    // Absolute move at the requested feedrate (mm/min). Zero-length moves are ignored.
+    void addMove(double x, double y, double z, double feedrate);
+    bool addMove(const GCodeCommand &cmd);
+
+    void plan();
+
+    int segmentCount() const { return int(m_length.size()); }
+    double segmentLength(int i) const { return m_length[size_t(i)]; }
+    double segmentTime(int i) const { return m_time[size_t(i)]; }
+    double entrySpeed(int i) const { return m_entry[size_t(i)]; } // mm/s
+
+    // Highest feedrate (mm/min) the move actually reaches after planning
+    double plannedFeedrate(int i) const { return m_peak[size_t(i)] * 60.0; }
+    // Feedrate cap (mm/min) for a move in this direction from the axis limits
+    double maxFeedrate(double dx, double dy, double dz) const;
+
+    double totalTime() const; // s
+    // Time left when fraction of segment i is done (ETA)
+    double remainingTime(int segment, double fraction = 0.0) const;
+    // Distance (mm) covered t seconds into segment i, and the speed there.
+    // Speed is taken as linear over each ramp: exact for the trapezoidal
+    // profile, matching the S-curve at the ends of its ramps.
+    double distanceAt(int segment, double t, double *speed = nullptr) const;
+    // Inverse of distanceAt(): seconds into segment i at which distance is reached
+    double timeAt(int segment, double distance) const;
+
+    // Updates limits from a Marlin settings report such as
+    //   "echo:  M203 X300.00 Y300.00 Z5.00 E25.00"
+    //   "echo:  M201 X3000.00 Y3000.00 Z100.00 E10000.00"
+    // Returns true if the line carried M203 or M201 values.
+    static bool parseLimitsReport(std::string_view line, MotionLimits &limits);
+
+private:
+    MotionLimits m_limits;
+    Profile m_profile = Trapezoidal;
+    double m_endX = 0.0, m_endY = 0.0, m_endZ = 0.0;
+    double m_startSpeed = 0.0;
+
+    // Segment buffer, structure of arrays
+    std::vector<double> m_unitX, m_unitY, m_unitZ; // Direction
+    std::vector<double> m_length;                  // mm
+    std::vector<double> m_cruise;                  // Velocity cap, mm/s
+    std::vector<double> m_accel;                   // Acceleration cap, mm/s^2
+    std::vector<double> m_entry;                   // Planned entry speed, mm/s
+    std::vector<double> m_peak;                    // Highest speed reached, mm/s
+    std::vector<double> m_time;                    // s
+    std::vector<double> m_timeAfter;               // Time of all later segments, s
+
+    double speedChangeTime(double v0, double v1, double accel) const;
+    double segmentTiming(double v0, double v1, double cruise, double accel, double length, double &peak) const;
+};
+
+#endif // MOTIONPLANNER_H
@@ -1,11 +1,19 @@
 #include "MotorControlWidget.h"
+#include "TinybeeController.h"
+#include "JogCoalescer.h"
+#include "ContinuousJog.h"
+#include "PositionEstimator.h"
+#include <QKeyEvent>
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QApplication>
 #include <QTime>
 #include <QSplitter>
 #include <QGroupBox>
-#include <QRegularExpression>
 #include <QFont>
+#include <QCheckBox>
+#include <QScrollBar>
+#include <QScreen>
 #include <QDebug>
 #include <limits>
 
@@ -158,7 +166,9 @@ AxisControlWidget::AxisControlWidget(const QString &axis, QWidget *parent)
 void AxisControlWidget::setPosition(double pos)
 {
     posLabel->setText(QString::asprintf("%.2f mm", pos));
-    goSpin->setValue(pos);
+    // Updated every frame while moving; do not overwrite a target being typed
+    if (!goSpin->hasFocus())
+        goSpin->setValue(pos);
 }
 
 void AxisControlWidget::setEnabledAll(bool enabled)
@@ -178,8 +188,12 @@ void AxisControlWidget::setEnabledAll(bool enabled)
 
 MotorControlWidget::MotorControlWidget(QWidget *parent)
     : QWidget(parent),
-      serial(new QSerialPort(this)),
-      pollTimer(new QTimer(this)),
+      controller(new TinyBeeController(this)),
+      estimator(new PositionEstimator(controller, this)),
+      jogger(new JogCoalescer(controller, this)),
+      holdJog(new ContinuousJog(controller, this)),
+      holdDelayTimer(new QTimer(this)),
+      uiFrameTimer(new QTimer(this)),
       connected(false)
 {
     setupUI();
@@ -189,23 +203,72 @@ MotorControlWidget::MotorControlWidget(QWidget *parent)
     connect(refreshBtn, &QPushButton::clicked, this, &MotorControlWidget::refreshPorts);
     connect(connectBtn, &QPushButton::clicked, this, &MotorControlWidget::connectPort);
     connect(disconnectBtn, &QPushButton::clicked, this, &MotorControlWidget::disconnectPort);
-    connect(estopBtn, &QPushButton::clicked, this, &MotorControlWidget::emergencyStop);
+    connect(replayBtn, &QPushButton::clicked, this, &MotorControlWidget::chooseReplay);
+    // On press, not release: a click only completes when the button is let go
+    connect(estopBtn, &QPushButton::pressed, this, &MotorControlWidget::emergencyStop);
     connect(sendCommandBtn, &QPushButton::clicked, [this]()
             {
         sendCustomCommand(commandInput->text());
         commandInput->clear(); });
     connect(commandInput, &QLineEdit::returnPressed, this, &MotorControlWidget::onCommandInputReturnPressed);
 
-    connect(serial, &QSerialPort::readyRead, this, &MotorControlWidget::handleSerialReadyRead);
-    connect(pollTimer, &QTimer::timeout, this, &MotorControlWidget::updatePositionPoll);
+    connect(controller, &TinyBeeController::lineReceived, this, &MotorControlWidget::handleSerialLine);
+    connect(controller, &TinyBeeController::positionUpdated, this, &MotorControlWidget::handlePositionUpdate);
+    connect(controller, &TinyBeeController::commandQueued, this, &MotorControlWidget::scheduleUiFrame);
+    connect(controller, &TinyBeeController::errorOccurred, this, &MotorControlWidget::handleControllerError);
+    connect(controller, &TinyBeeController::disconnected, this, &MotorControlWidget::handleControllerDisconnected);
+    connect(controller, &TinyBeeController::logMessage, this, &MotorControlWidget::updateStatus);
+    connect(controller, &TinyBeeController::replayLineSent, this, [this](const QString &line)
+            { appendLog(SerialLogModel::Tx, SerialLogModel::Normal, line); });
+    connect(controller, &TinyBeeController::replayFinished, this, [this]()
+            { updateStatus(QString("Replay finished (%1 position updates merged, %2 log lines dropped)")
+                               .arg(uiMergedUpdates)
+                               .arg(uiDroppedLines)); });
+    connect(controller, &TinyBeeController::emergencyStopSent, this, [this](qint64 latencyNs)
+            {
+        appendLog(SerialLogModel::Tx, SerialLogModel::Normal, "M112");
+        updateStatus(QString("Emergency stop on the wire %1 ms after the press").arg(double(latencyNs) / 1e6, 0, 'f', 2)); });
+    connect(controller, &TinyBeeController::motionLimitsReceived, this, [this](const MotionLimits &limits)
+            {
+        planner.setLimits(limits);
+        estimator->setLimits(limits);
+        updateStatus(QString("Motion limits: max %1/%2/%3 mm/s, accel %4/%5/%6 mm/s²")
+                         .arg(limits.maxVelocity[0]).arg(limits.maxVelocity[1]).arg(limits.maxVelocity[2])
+                         .arg(limits.maxAcceleration[0]).arg(limits.maxAcceleration[1]).arg(limits.maxAcceleration[2])); });
+    connect(jogger, &JogCoalescer::jogSent, this, [this](const QString &commands)
+            { appendLog(SerialLogModel::Tx, SerialLogModel::Normal, commands); });
+
+    // Hold-to-jog: a button counts as held after 300 ms; arrow keys jog X/Y,
+    // Page Up/Down jog Z
+    holdDelayTimer->setSingleShot(true);
+    holdDelayTimer->setInterval(300);
+    connect(holdDelayTimer, &QTimer::timeout, this, [this]()
+            {
+        if (!isConnected())
+            return;
+        holdEngaged = true;
+        jogger->flush();
+        holdJog->begin(holdDirX, holdDirY, holdDirZ); });
+    connect(holdJog, &ContinuousJog::stopped, this, [this](qint64 latencyMs)
+            { updateStatus(QString("Jog stopped %1 ms after release (max %2 ms, limit %3 mm)")
+                               .arg(latencyMs)
+                               .arg(holdJog->maxStopLatencyMs())
+                               .arg(holdJog->maxStopDistance(), 0, 'f', 2)); });
+    setFocusPolicy(Qt::StrongFocus);
+
+    // Coalesce RX-driven repaints to the display refresh rate
+    qreal refreshHz = 60.0;
+    if (QScreen *screen = QGuiApplication::primaryScreen())
+        refreshHz = screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    uiFrameTimer->setSingleShot(true);
+    uiFrameTimer->setInterval(qMax(1, qRound(1000.0 / refreshHz)));
+    connect(uiFrameTimer, &QTimer::timeout, this, &MotorControlWidget::flushUiFrame);
 }
 
 MotorControlWidget::~MotorControlWidget()
 {
-    if (serial->isOpen())
-    {
-        serial->close();
-    }
+    // The controller closes the port and stops its I/O thread when destroyed
+    disconnect(controller, nullptr, this, nullptr);
 }
 
 void MotorControlWidget::setupUI()
@@ -228,6 +291,7 @@ void MotorControlWidget::setupUI()
     QLabel *portLabel = new QLabel("Port:");
     portCombo = new QComboBox();
     portCombo->setMinimumWidth(150);
+    portCombo->setEditable(true); // Devices not listed by QSerialPortInfo, e.g. /dev/pts/3
 
     QLabel *baudLabel = new QLabel("Baud:");
     QComboBox *baudCombo = new QComboBox();
@@ -248,6 +312,15 @@ void MotorControlWidget::setupUI()
     disconnectBtn->setStyleSheet("QPushButton { background: #f44336; color: white; font-weight: bold; border-radius: 5px; padding: 6px; } QPushButton:hover { background: #d32f2f; }");
     disconnectBtn->setEnabled(false);
 
+    // Recorded sessions (TinyBeeController::startSessionCapture) play through the same path
+    replayBtn = new QPushButton("Replay...");
+    replayBtn->setFixedWidth(80);
+    replayBtn->setStyleSheet("QPushButton { background: #607D8B; color: white; font-weight: bold; border-radius: 5px; padding: 6px; } QPushButton:hover { background: #455A64; }");
+    replaySpeedCombo = new QComboBox();
+    replaySpeedCombo->addItem("1x", 1.0);
+    replaySpeedCombo->addItem("10x", 10.0);
+    replaySpeedCombo->addItem("Max", 0.0);
+
     statusLabel = new QLabel("Disconnected");
     statusLabel->setAlignment(Qt::AlignCenter);
     statusLabel->setStyleSheet("QLabel { color: #f44336; font-weight: bold; padding: 6px; border: 2px solid #f44336; border-radius: 5px; }");
@@ -259,6 +332,8 @@ void MotorControlWidget::setupUI()
     connLayout->addWidget(refreshBtn);
     connLayout->addWidget(connectBtn);
     connLayout->addWidget(disconnectBtn);
+    connLayout->addWidget(replayBtn);
+    connLayout->addWidget(replaySpeedCombo);
     connLayout->addStretch();
     connLayout->addWidget(statusLabel);
 
@@ -456,16 +531,23 @@ void MotorControlWidget::setupUI()
     QVBoxLayout *statusLayout = new QVBoxLayout(statusGroup);
     statusLayout->setSpacing(4);
 
-    statusLog = new QTextEdit();
-    statusLog->setReadOnly(true);
-    statusLog->setStyleSheet("QTextEdit { background: #f9f9f9; border: 2px solid #ddd; border-radius: 5px; font-family: monospace; font-size: 11px; color: black; }");
+    // Bounded model; uniform row heights let the view lay out only visible rows
+    logModel = new SerialLogModel(5000, 256 * 1024, this);
+    statusLog = new QListView();
+    statusLog->setModel(logModel);
+    statusLog->setUniformItemSizes(true);
+    statusLog->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statusLog->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    statusLog->setStyleSheet("QListView { background: #f9f9f9; border: 2px solid #ddd; border-radius: 5px; font-family: monospace; font-size: 11px; color: black; }");
     statusLog->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
     QHBoxLayout *logButtonLayout = new QHBoxLayout();
+    QCheckBox *hideChatterCheck = new QCheckBox("Hide position polling");
     QPushButton *clearBtn = new QPushButton("Clear");
     clearBtn->setFixedWidth(80);
     clearBtn->setStyleSheet("QPushButton { background: #757575; color: white; font-weight: bold; border-radius: 5px; padding: 4px; } QPushButton:hover { background: #616161; }");
 
+    logButtonLayout->addWidget(hideChatterCheck);
     logButtonLayout->addStretch();
     logButtonLayout->addWidget(clearBtn);
 
@@ -487,7 +569,6 @@ void MotorControlWidget::setupUI()
     connect(refreshBtn, &QPushButton::clicked, this, &MotorControlWidget::refreshPorts);
     connect(connectBtn, &QPushButton::clicked, this, &MotorControlWidget::connectPort);
     connect(disconnectBtn, &QPushButton::clicked, this, &MotorControlWidget::disconnectPort);
-    connect(estopBtn, &QPushButton::clicked, this, &MotorControlWidget::emergencyStop);
     connect(sendCommandBtn, &QPushButton::clicked, [this]()
             {
         QString cmd = commandInput->text();
@@ -502,36 +583,32 @@ void MotorControlWidget::setupUI()
             sendCustomCommand(cmd);
             commandInput->clear();
         } });
-    connect(clearBtn, &QPushButton::clicked, statusLog, &QTextEdit::clear);
+    connect(clearBtn, &QPushButton::clicked, [this]()
+            {
+        pendingLog.clear();
+        logModel->clear(); });
+    connect(hideChatterCheck, &QCheckBox::toggled, logModel, &SerialLogModel::setHideChatter);
     connect(homeAllBtn, &QPushButton::clicked, [this]()
             { sendCustomCommand("G28"); });
 
     // === DIRECTIONAL BUTTON CONNECTIONS (with proper X/Z axis reversal) ===
     // Basic directions
-    connect(northBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 Y%1 F1000\nG90").arg(stepSpinBox->value())); });
-    connect(southBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 Y%1 F1000\nG90").arg(-stepSpinBox->value())); });
-    connect(eastBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 X%1 F1000\nG90").arg(-stepSpinBox->value())); }); // X reversed
-    connect(westBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 X%1 F1000\nG90").arg(stepSpinBox->value())); }); // X reversed
+    // Click: one step (rapid clicks are merged by the jog coalescer).
+    // Press and hold: continuous jog until released.
+    connectJogButton(northBtn, 0, 1, 0, stepSpinBox);
+    connectJogButton(southBtn, 0, -1, 0, stepSpinBox);
+    connectJogButton(eastBtn, -1, 0, 0, stepSpinBox); // X reversed
+    connectJogButton(westBtn, 1, 0, 0, stepSpinBox);  // X reversed
 
     // Diagonal movements
-    connect(neBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 X%1 Y%2 F1000\nG90").arg(-stepSpinBox->value()).arg(stepSpinBox->value())); });
-    connect(nwBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 X%1 Y%2 F1000\nG90").arg(stepSpinBox->value()).arg(stepSpinBox->value())); });
-    connect(seBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 X%1 Y%2 F1000\nG90").arg(-stepSpinBox->value()).arg(-stepSpinBox->value())); });
-    connect(swBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 X%1 Y%2 F1000\nG90").arg(stepSpinBox->value()).arg(-stepSpinBox->value())); });
+    connectJogButton(neBtn, -1, 1, 0, stepSpinBox);
+    connectJogButton(nwBtn, 1, 1, 0, stepSpinBox);
+    connectJogButton(seBtn, -1, -1, 0, stepSpinBox);
+    connectJogButton(swBtn, 1, -1, 0, stepSpinBox);
 
     // Z controls with reversal
-    connect(zUpBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 Z%1 F1000\nG90").arg(-stepSpinBox->value())); }); // Z reversed
-    connect(zDownBtn, &QPushButton::clicked, [this, stepSpinBox]()
-            { sendCustomCommand(QString("G91\nG1 Z%1 F1000\nG90").arg(stepSpinBox->value())); }); // Z reversed
+    connectJogButton(zUpBtn, 0, 0, -1, stepSpinBox);  // Z reversed
+    connectJogButton(zDownBtn, 0, 0, 1, stepSpinBox); // Z reversed
 
     // HOME button
     connect(homeBtn, &QPushButton::clicked, [this]()
@@ -544,7 +621,7 @@ void MotorControlWidget::setupUI()
 
 bool MotorControlWidget::isConnected() const
 {
-    return connected && serial->isOpen();
+    return connected && controller->isConnected();
 }
 
 void MotorControlWidget::showWidget()
@@ -563,7 +640,8 @@ void MotorControlWidget::connectToPort(const QString &portName)
 {
     if (!portName.isEmpty())
     {
-        // Find and select the specified port
+        // Find and select the specified port; anything else is used as a device path
+        portCombo->setCurrentText(portName);
         for (int i = 0; i < portCombo->count(); ++i)
         {
             if (portCombo->itemText(i).contains(portName))
@@ -597,17 +675,18 @@ void MotorControlWidget::sendCustomCommand(const QString &command)
         return;
     }
 
-    QString cmd = trimmedCmd;
-    if (!cmd.endsWith('\n'))
+    // Collected jogs were requested first, so they go out first
+    jogger->flush();
+
+    // Multi-line commands (e.g. relative jogs) are queued line by line
+    const QStringList lines = trimmedCmd.split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines)
     {
-        cmd += '\n';
+        controller->enqueueLine(line.trimmed().toUtf8());
     }
 
-    serial->write(cmd.toUtf8());
-
-    // Add sent command to status log with timestamp and color
-    QString timestamp = QTime::currentTime().toString("hh:mm:ss");
-    statusLog->append(QString("[%1] <span style='color: orange;'>TX: %2</span>").arg(timestamp, trimmedCmd));
+    // Add sent command to status log
+    appendLog(SerialLogModel::Tx, SerialLogModel::Normal, trimmedCmd);
 
     updateStatus("Sent: " + trimmedCmd);
     emit commandExecuted(command.trimmed(), ""); // Response will be handled in serial read
@@ -639,59 +718,79 @@ void MotorControlWidget::connectPort()
 
     QString portName = portText.split(" ").first();
 
-    if (serial->isOpen())
+    if (!controller->connectPort(portName, 115200))
     {
-        serial->close();
+        QString error = QString("Failed to open port %1").arg(portName);
+        QMessageBox::critical(this, "Connection Error", error);
+        updateStatus("Connection failed: " + error);
+        return;
     }
 
-    serial->setPortName(portName);
-    serial->setBaudRate(115200);
-    serial->setDataBits(QSerialPort::Data8);
-    serial->setParity(QSerialPort::NoParity);
-    serial->setStopBits(QSerialPort::OneStop);
-    serial->setFlowControl(QSerialPort::NoFlowControl);
+    enterConnectedState(portName, true);
 
-    if (!serial->open(QIODevice::ReadWrite))
+    // The estimator interpolates between real-time reports ("M114 R"), so
+    // moving polls can be sparse; slow (or firmware auto-report) while idle
+    controller->startPositionUpdates(250, 1000);
+    controller->queryMotionLimits();
+    emit connectionStatusChanged(true);
+}
+
+void MotorControlWidget::chooseReplay()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Replay Serial Session", QString(),
+                                                      "Serial sessions (*.tbsession);;All files (*)");
+    if (!path.isEmpty())
+        replaySession(path, replaySpeedCombo->currentData().toDouble());
+}
+
+void MotorControlWidget::replaySession(const QString &path, double speed)
+{
+    if (!controller->connectReplay(path, speed))
     {
-        QString error = QString("Failed to open port %1: %2").arg(portName, serial->errorString());
-        QMessageBox::critical(this, "Connection Error", error);
-        updateStatus("Connection failed: " + error);
-        emit errorOccurred(error);
+        QMessageBox::critical(this, "Replay Error", QString("Failed to replay %1").arg(path));
         return;
     }
 
+    // The recording already holds the M114 traffic of the original session,
+    // and there is no machine to move, so nothing is polled or sent
+    const QString rate = speed > 0.0 ? QString("%1x").arg(speed) : QString("max speed");
+    enterConnectedState(QString("replay of %1 at %2").arg(path, rate), false);
+    emit connectionStatusChanged(true);
+}
+
+void MotorControlWidget::enterConnectedState(const QString &source, bool controlsEnabled)
+{
     connected = true;
-    updateStatus("✅ Connected to " + portName);
-    statusLabel->setText("Connected");
+    updateStatus("✅ Connected to " + source);
+    statusLabel->setText(controlsEnabled ? "Connected" : "Replaying");
     statusLabel->setStyleSheet("font-weight: bold; color: #28a745; font-size: 12px; padding: 8px; background: #d4edda; border-radius: 4px; border: 1px solid #c3e6cb;");
 
     connectBtn->setEnabled(false);
+    replayBtn->setEnabled(false);
     disconnectBtn->setEnabled(true);
 
     for (auto *aw : axisControls)
     {
-        aw->setEnabledAll(true);
+        aw->setEnabledAll(controlsEnabled);
     }
-
-    pollTimer->start(750); // Poll position every 750ms
-    emit connectionStatusChanged(true);
 }
 
 void MotorControlWidget::disconnectPort()
 {
-    if (serial->isOpen())
-    {
-        serial->close();
-    }
+    // UI is reset by handleControllerDisconnected()
+    controller->disconnectPort();
+}
 
+void MotorControlWidget::handleControllerDisconnected()
+{
     connected = false;
-    pollTimer->stop();
 
     updateStatus("❌ Disconnected");
     statusLabel->setText("Disconnected");
     statusLabel->setStyleSheet("font-weight: bold; color: #dc3545; font-size: 12px; padding: 8px; background: #f8d7da; border-radius: 4px; border: 1px solid #f5c6cb;");
 
     connectBtn->setEnabled(true);
+    replayBtn->setEnabled(true);
     disconnectBtn->setEnabled(false);
 
     for (auto *aw : axisControls)
@@ -704,8 +803,76 @@ void MotorControlWidget::disconnectPort()
 
 void MotorControlWidget::updateStatus(const QString &message)
 {
-    QString timestamp = QTime::currentTime().toString("hh:mm:ss");
-    statusLog->append(QString("[%1] %2").arg(timestamp, message));
+    appendLog(SerialLogModel::Info, SerialLogModel::Normal, message);
+}
+
+void MotorControlWidget::appendLog(SerialLogModel::Direction direction, SerialLogModel::Severity severity, const QString &text)
+{
+    // Only the newest lines can survive in the log anyway; trim in bulk so a
+    // stalled event loop cannot grow the backlog without limit
+    if (pendingLog.size() >= 2 * logModel->maxEntries())
+    {
+        const int excess = pendingLog.size() - logModel->maxEntries();
+        pendingLog.erase(pendingLog.begin(), pendingLog.begin() + excess);
+        uiDroppedLines += quint64(excess);
+    }
+
+    pendingLog.append(SerialLogModel::makeEntry(direction, severity, text));
+    scheduleUiFrame();
+}
+
+void MotorControlWidget::scheduleUiFrame()
+{
+    if (!uiFrameTimer->isActive())
+        uiFrameTimer->start();
+}
+
+void MotorControlWidget::flushUiFrame()
+{
+    // positionChanged() carries firmware reports only; the display and
+    // positionEstimated() are dead-reckoned and redrawn every frame while moving
+    const bool reported = positionPending;
+    if (positionPending)
+    {
+        positionPending = false;
+        lastPosX = pendingPosX;
+        lastPosY = pendingPosY;
+        lastPosZ = pendingPosZ;
+    }
+
+    const bool moving = estimator->isMoving();
+    if (reported || moving)
+    {
+        const PositionEstimate estimate = estimator->estimate();
+        const double reportedPos[3] = {lastPosX, lastPosY, lastPosZ};
+
+        // Update axis control widgets
+        for (auto *aw : axisControls)
+        {
+            const int index = aw->axisName == "x" ? 0 : aw->axisName == "y" ? 1 : 2;
+            const QString axis = aw->axisName.toUpper();
+            aw->setPosition(estimate.pos[index]);
+            if (reported)
+                emit positionChanged(axis, reportedPos[index]);
+            emit positionEstimated(axis, estimate.pos[index]);
+        }
+
+        if (moving)
+            scheduleUiFrame();
+    }
+
+    if (!pendingLog.isEmpty())
+    {
+        // Follow new entries only while the user has not scrolled back
+        QScrollBar *bar = statusLog->verticalScrollBar();
+        const bool atBottom = bar->value() >= bar->maximum();
+
+        uiDroppedLines += quint64(logModel->appendBatch(pendingLog));
+        pendingLog.clear();
+
+        if (atBottom)
+            statusLog->scrollToBottom();
+    }
 }
 
 void MotorControlWidget::directionalClicked()
@@ -762,7 +929,10 @@ void MotorControlWidget::axisMoveStep()
 
     bool minus = (sender() == aw->moveMinusBtn);
     double step = aw->stepSpin->value();
-    double curr = aw->goSpin->value();
+    // Step from where the queued moves end, not from the last displayed
+    // position, so repeated clicks add up while the axis is still moving
+    const QString axis = aw->axisName.toLower();
+    double curr = estimator->commandedPosition(axis == "x" ? 0 : axis == "y" ? 1 : 2);
 
     // Reverse direction for X and Z axes (invert the button behavior)
     if (aw->axisName.toLower() == "x" || aw->axisName.toLower() == "z")
@@ -771,8 +941,7 @@ void MotorControlWidget::axisMoveStep()
     }
 
     double pos = curr + (minus ? -step : step);
-    QString command = QString("G1 %1%2 F3000").arg(aw->axisName.toUpper()).arg(pos);
-    sendCustomCommand(command);
+    sendCustomCommand(plannedAxisMove(aw->axisName, pos));
 }
 
 void MotorControlWidget::axisGoTo()
@@ -782,8 +951,28 @@ void MotorControlWidget::axisGoTo()
         return;
 
     double pos = aw->goSpin->value();
-    QString command = QString("G1 %1%2 F3000").arg(aw->axisName.toUpper()).arg(pos);
-    sendCustomCommand(command);
+    sendCustomCommand(plannedAxisMove(aw->axisName, pos));
+}
+
+QString MotorControlWidget::plannedAxisMove(const QString &axis, double target)
+{
+    // Plan from where the queued moves end so the feedrate respects the
+    // axis limits and the ETA includes acceleration
+    double from[3] = {estimator->commandedPosition(0), estimator->commandedPosition(1), estimator->commandedPosition(2)};
+    double to[3] = {from[0], from[1], from[2]};
+    const int index = axis.toLower() == "x" ? 0 : axis.toLower() == "y" ? 1 : 2;
+    to[index] = target;
+
+    const double feedrate = qMin(3000.0, planner.maxFeedrate(to[0] - from[0], to[1] - from[1], to[2] - from[2]));
+    planner.clear();
+    planner.setStartPosition(from[0], from[1], from[2]);
+    planner.addMove(to[0], to[1], to[2], feedrate);
+    planner.plan();
+
+    const int f = qMax(1, qRound(feedrate > 0.0 ? feedrate : 3000.0));
+    if (planner.segmentCount() > 0)
+        updateStatus(QString("Moving %1 to %2 mm at F%3, ETA %4 s").arg(axis.toUpper()).arg(target, 0, 'f', 2).arg(f).arg(planner.totalTime(), 0, 'f', 2));
+    return QString("G1 %1%2 F%3").arg(axis.toUpper()).arg(target).arg(f);
 }
 
 void MotorControlWidget::markPosition()
@@ -834,22 +1023,118 @@ void MotorControlWidget::emergencyStop()
 {
     if (isConnected())
     {
-        sendCustomCommand("M112"); // Emergency stop G-code
+        // Out of band, ahead of queued jogs and the log update below
+        controller->emergencyStop();
+        jogger->cancel();
+        heldKeys.clear();
+        holdDelayTimer->stop();
+        holdJog->abort();
         updateStatus("EMERGENCY STOP ACTIVATED");
     }
 }
 
-void MotorControlWidget::updatePositionPoll()
+void MotorControlWidget::connectJogButton(QPushButton *btn, double dirX, double dirY, double dirZ, QDoubleSpinBox *stepSpinBox)
 {
-    if (isConnected())
+    connect(btn, &QPushButton::clicked, [this, dirX, dirY, dirZ, stepSpinBox]()
+            {
+        // The click that ends a hold is not an extra step
+        if (holdEngaged)
+            return;
+        const double step = stepSpinBox->value();
+        jogger->jog(dirX * step, dirY * step, dirZ * step); });
+    connect(btn, &QPushButton::pressed, [this, dirX, dirY, dirZ]()
+            {
+        holdDirX = dirX;
+        holdDirY = dirY;
+        holdDirZ = dirZ;
+        holdDelayTimer->start(); });
+    connect(btn, &QPushButton::released, [this]()
+            {
+        holdDelayTimer->stop();
+        if (!holdEngaged)
+            return;
+        holdJog->end();
+        // clicked() follows released() synchronously; reset once it has been seen
+        QTimer::singleShot(0, this, [this]()
+                           { holdEngaged = false; }); });
+}
+
+void MotorControlWidget::keyPressEvent(QKeyEvent *event)
+{
+    if (!isJogKey(event->key()))
+    {
+        QWidget::keyPressEvent(event);
+        return;
+    }
+    if (!event->isAutoRepeat())
+    {
+        heldKeys.insert(event->key());
+        updateKeyJog();
+    }
+    event->accept();
+}
+
+void MotorControlWidget::keyReleaseEvent(QKeyEvent *event)
+{
+    if (!isJogKey(event->key()))
+    {
+        QWidget::keyReleaseEvent(event);
+        return;
+    }
+    if (!event->isAutoRepeat())
     {
-        sendCustomCommand("M114"); // Request position
+        heldKeys.remove(event->key());
+        updateKeyJog();
     }
+    event->accept();
 }
 
-void MotorControlWidget::handleSerialReadyRead()
+void MotorControlWidget::focusOutEvent(QFocusEvent *event)
 {
-    handleSerialRead();
+    // Key releases are not delivered once focus is gone
+    if (!heldKeys.isEmpty())
+    {
+        heldKeys.clear();
+        updateKeyJog();
+    }
+    QWidget::focusOutEvent(event);
+}
+
+bool MotorControlWidget::isJogKey(int key)
+{
+    return key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_Left || key == Qt::Key_Right ||
+           key == Qt::Key_PageUp || key == Qt::Key_PageDown;
+}
+
+void MotorControlWidget::updateKeyJog()
+{
+    // Same directions as the jog pad (X and Z reversed)
+    double dx = 0, dy = 0, dz = 0;
+    for (int key : heldKeys)
+    {
+        if (key == Qt::Key_Up)
+            dy += 1;
+        else if (key == Qt::Key_Down)
+            dy -= 1;
+        else if (key == Qt::Key_Right)
+            dx -= 1;
+        else if (key == Qt::Key_Left)
+            dx += 1;
+        else if (key == Qt::Key_PageUp)
+            dz -= 1;
+        else if (key == Qt::Key_PageDown)
+            dz += 1;
+    }
+
+    if (dx == 0 && dy == 0 && dz == 0)
+    {
+        holdJog->end();
+        return;
+    }
+    if (!isConnected())
+        return;
+    jogger->flush();
+    holdJog->begin(dx, dy, dz);
 }
 
 void MotorControlWidget::onCommandInputReturnPressed()
@@ -870,76 +1155,41 @@ AxisMeasurement *MotorControlWidget::measurement(const QString &axis)
     return nullptr;
 }
 
-void MotorControlWidget::handleSerialRead()
+void MotorControlWidget::handleSerialLine(const QString &line)
 {
-    QByteArray newData = serial->readAll();
-    buffer.append(newData);
-
-    // Process complete lines
-    while (buffer.contains('\n'))
+    // Color code different types of responses
+    SerialLogModel::Severity severity = SerialLogModel::Normal;
+    if (line.startsWith("ok") || line.contains("OK"))
     {
-        int lineEnd = buffer.indexOf('\n');
-        QByteArray lineData = buffer.left(lineEnd);
-        buffer.remove(0, lineEnd + 1);
-
-        QString line = QString::fromUtf8(lineData).trimmed();
-        if (line.isEmpty())
-            continue;
-
-        QString timestamp = QTime::currentTime().toString("hh:mm:ss");
+        severity = SerialLogModel::Ok;
+    }
+    else if (line.startsWith("error") || line.startsWith("Error") || line.contains("error") || line.contains("Error"))
+    {
+        severity = SerialLogModel::Error;
+    }
+    else if (line.startsWith("//") || line.startsWith(";"))
+    {
+        severity = SerialLogModel::Comment;
+    }
 
-        // Color code different types of responses
-        QString displayLine;
-        if (line.startsWith("ok") || line.contains("OK"))
-        {
-            displayLine = QString("[%1] <span style='color: green;'>RX: %2</span>").arg(timestamp, line);
-        }
-        else if (line.startsWith("error") || line.startsWith("Error") || line.contains("error") || line.contains("Error"))
-        {
-            displayLine = QString("[%1] <span style='color: red;'>RX: %2</span>").arg(timestamp, line);
-        }
-        else if (line.startsWith("//") || line.startsWith(";"))
-        {
-            displayLine = QString("[%1] <span style='color: gray;'>RX: %2</span>").arg(timestamp, line);
-        }
-        else
-        {
-            displayLine = QString("[%1] <span style='color: blue;'>RX: %2</span>").arg(timestamp, line);
-        }
+    appendLog(SerialLogModel::Rx, severity, line);
+}
 
-        statusLog->append(displayLine);
+void MotorControlWidget::handlePositionUpdate(const MotorPosition &pos)
+{
+    // Only the latest report per frame is shown; the estimator has already
+    // taken this one
+    if (positionPending)
+        ++uiMergedUpdates;
+    positionPending = true;
+    pendingPosX = pos.x;
+    pendingPosY = pos.y;
+    pendingPosZ = pos.z;
+    scheduleUiFrame();
+}
 
-        // Parse position updates (M114 response)
-        if (line.contains("X:") && line.contains("Y:") && line.contains("Z:"))
-        {
-            QRegularExpression rx(R"(X:([-+]?\d*\.?\d+)\s+Y:([-+]?\d*\.?\d+)\s+Z:([-+]?\d*\.?\d+))");
-            QRegularExpressionMatch match = rx.match(line);
-            if (match.hasMatch())
-            {
-                lastPosX = match.captured(1).toDouble();
-                lastPosY = match.captured(2).toDouble();
-                lastPosZ = match.captured(3).toDouble();
-
-                // Update axis control widgets
-                for (auto *aw : axisControls)
-                {
-                    if (aw->axisName == "x")
-                    {
-                        aw->setPosition(lastPosX);
-                        emit positionChanged("X", lastPosX);
-                    }
-                    else if (aw->axisName == "y")
-                    {
-                        aw->setPosition(lastPosY);
-                        emit positionChanged("Y", lastPosY);
-                    }
-                    else if (aw->axisName == "z")
-                    {
-                        aw->setPosition(lastPosZ);
-                        emit positionChanged("Z", lastPosZ);
-                    }
-                }
-            }
-        }
-    }
+void MotorControlWidget::handleControllerError(const QString &error)
+{
+    updateStatus("Error: " + error);
+    emit errorOccurred(error);
 }
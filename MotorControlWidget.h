@@ -6,7 +6,7 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QComboBox>
-#include <QTextEdit>
+#include <QListView>
 #include <QLineEdit>
 #include <QDoubleSpinBox>
 #include <QHBoxLayout>
@@ -17,6 +17,15 @@
 #include <QSerialPortInfo>
 #include <QTimer>
 #include <QVector>
+#include <QSet>
+#include "SerialLogModel.h"
+#include "MotionPlanner.h"
+
+class TinyBeeController;
+class JogCoalescer;
+class ContinuousJog;
+class PositionEstimator;
+struct MotorPosition;
 
 struct AxisMeasurement
 {
@@ -53,60 +62,112 @@ public:
     bool isConnected() const;
     void showWidget();
     void hideWidget();
+    TinyBeeController *motorController() const { return controller; }
+
+    // UI throughput counters: position reports superseded before they were
+    // shown, and log lines discarded because more arrived than the log holds
+    quint64 mergedUpdateCount() const { return uiMergedUpdates; }
+    quint64 droppedLogLineCount() const { return uiDroppedLines; }
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+    void keyReleaseEvent(QKeyEvent *event) override;
+    void focusOutEvent(QFocusEvent *event) override;
 
 signals:
     void connectionStatusChanged(bool connected);
+    // Position reported by the firmware (M114 or auto-report)
     void positionChanged(const QString &axis, double position);
+    // Dead-reckoned position shown between reports, every frame while moving
+    void positionEstimated(const QString &axis, double position);
     void errorOccurred(const QString &error);
     void commandExecuted(const QString &command, const QString &response);
 
 public slots:
     void connectToPort(const QString &portName = "");
     void disconnectFromPort();
+    // Plays a recorded session instead of a port (speed 0 = unpaced)
+    void replaySession(const QString &path, double speed = 1.0);
     void sendCustomCommand(const QString &command);
 
 private slots:
     void refreshPorts();
     void connectPort();
     void disconnectPort();
+    void chooseReplay();
     void directionalClicked();
     void axisHome();
     void axisMoveStep();
     void axisGoTo();
     void markPosition();
     void emergencyStop();
-    void updatePositionPoll();
-    void handleSerialReadyRead();
     void onCommandInputReturnPressed();
+    void handleSerialLine(const QString &line);
+    void handlePositionUpdate(const MotorPosition &pos);
+    void handleControllerError(const QString &error);
+    void handleControllerDisconnected();
+    void flushUiFrame();
 
 private:
     void setupUI();
     void updateStatus(const QString &message);
+    void appendLog(SerialLogModel::Direction direction, SerialLogModel::Severity severity, const QString &text);
+    void enterConnectedState(const QString &source, bool controlsEnabled);
     AxisMeasurement *measurement(const QString &axis);
 
     // UI Components
     QComboBox *portCombo;
     QPushButton *refreshBtn, *connectBtn, *disconnectBtn, *estopBtn;
+    QPushButton *replayBtn;
+    QComboBox *replaySpeedCombo;
     QLabel *statusLabel;
     QTabWidget *tabs;
     QVector<AxisControlWidget *> axisControls;
-    QTextEdit *statusLog;
+    QListView *statusLog;
+    SerialLogModel *logModel;
     QLineEdit *commandInput;
     QPushButton *sendCommandBtn;
 
     // Serial Communication
-    QSerialPort *serial;
-    QTimer *pollTimer;
+    TinyBeeController *controller;
+    PositionEstimator *estimator; // Constructed after the controller: sees each report first
+    JogCoalescer *jogger;
+    ContinuousJog *holdJog;
+    QTimer *holdDelayTimer;
+    QTimer *uiFrameTimer;
 
     // State
     bool connected;
     AxisMeasurement measX, measY, measZ;
-    QByteArray buffer;
     double lastPosX = 0.0;
     double lastPosY = 0.0;
     double lastPosZ = 0.0;
 
-    void handleSerialRead();
+    // RX-driven UI updates, applied once per display frame
+    QVector<SerialLogModel::Entry> pendingLog;
+    bool positionPending = false;
+    double pendingPosX = 0.0;
+    double pendingPosY = 0.0;
+    double pendingPosZ = 0.0;
+    quint64 uiMergedUpdates = 0;
+    quint64 uiDroppedLines = 0;
+
+    void scheduleUiFrame();
+
+    // Hold-to-jog state
+    bool holdEngaged = false;
+    double holdDirX = 0.0;
+    double holdDirY = 0.0;
+    double holdDirZ = 0.0;
+    QSet<int> heldKeys;
+
+    void connectJogButton(QPushButton *btn, double dirX, double dirY, double dirZ, QDoubleSpinBox *stepSpinBox);
+    void updateKeyJog();
+
+    // Feedrate selection and ETA for single-axis moves
+    MotionPlanner planner;
+    QString plannedAxisMove(const QString &axis, double target);
+    static bool isJogKey(int key);
 };
 
 #endif // MOTORCONTROLWIDGET_H
@@ -0,0 +1,476 @@
+// PositionEstimator.cpp
+#include "PositionEstimator.h"
+#include "LinkStatistics.h"
+#include "TinybeeController.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+// Reports carry two decimals; anything further from the path is not on it
+constexpr double OffPathTolerance = 0.1; // mm
+// Segments past the current one a report may be matched against
+constexpr int SearchAhead = 8;
+
+// Letter words of one line ("G1 X10 Y-2.5 F3000"), up to a comment
+struct Words
+{
+    bool has[26] = {};
+    double value[26] = {};
+
+    bool contains(char letter) const { return has[letter - 'A']; }
+    double operator[](char letter) const { return value[letter - 'A']; }
+};
+
+void parseWords(const QByteArray &line, Words &words)
+{
+    const char *p = line.constData();
+    const char *end = p + line.size();
+    while (p < end)
+    {
+        char c = *p++;
+        if (c == ';' || c == '(')
+            break;
+        if (c >= 'a' && c <= 'z')
+            c = char(c - 'a' + 'A');
+        if (c < 'A' || c > 'Z')
+            continue;
+
+        while (p < end && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (p < end && *p == '+')
+            ++p; // std::from_chars does not take a leading '+'
+        // Fixed notation: in "G1X10E5" the E is the next word, not an exponent
+        double value = 0.0;
+        const std::from_chars_result result = std::from_chars(p, end, value, std::chars_format::fixed);
+        if (result.ec != std::errc())
+            continue;
+        words.has[c - 'A'] = true;
+        words.value[c - 'A'] = value;
+        p = result.ptr;
+    }
+}
+
+double distance(const double a[3], const double b[3])
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+} // namespace
+
+PositionEstimator::PositionEstimator(TinyBeeController *controller, QObject *parent)
+    : QObject(parent)
+{
+    if (!controller)
+        return;
+
+    connect(controller, &TinyBeeController::commandQueued, this, [this](quint64 id, const QByteArray &line)
+            { queueLine(id, line); });
+    connect(controller, &TinyBeeController::commandCompleted, this, [this](quint64 id, const QString &)
+            { commandCompleted(id); });
+    connect(controller, &TinyBeeController::commandFailed, this, [this](quint64 id, const QString &)
+            { commandFailed(id); });
+    connect(controller, &TinyBeeController::positionUpdated, this, &PositionEstimator::applyReport);
+    connect(controller, &TinyBeeController::emergencyStopSent, this, [this](qint64)
+            { stop(); });
+    connect(controller, &TinyBeeController::motionLimitsReceived, this, &PositionEstimator::setLimits);
+}
+
+void PositionEstimator::setLimits(const MotionLimits &limits)
+{
+    m_planner.setLimits(limits);
+    m_planned = m_segments.isEmpty();
+}
+
+PositionEstimate PositionEstimator::estimate(qint64 nowNs) const
+{
+    PositionEstimate result;
+    if (m_segments.isEmpty() || m_homingId != 0)
+    {
+        std::copy(m_start, m_start + 3, result.pos);
+        result.moving = m_homingId != 0;
+        return result;
+    }
+
+    int segment;
+    double t;
+    locate(nowNs ? nowNs : LinkStatistics::nowNs(), segment, t);
+    if (segment < 0)
+    {
+        std::copy(m_segments.last().to, m_segments.last().to + 3, result.pos);
+        return result;
+    }
+
+    double speed = 0.0;
+    const double covered = m_planner.distanceAt(segment, t, &speed);
+    const double length = m_planner.segmentLength(segment);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const double from = segmentStart(segment, axis);
+        const double unit = (m_segments[segment].to[axis] - from) / length;
+        result.pos[axis] = from + unit * covered;
+        result.velocity[axis] = unit * speed;
+    }
+    result.moving = true;
+    return result;
+}
+
+bool PositionEstimator::isMoving(qint64 nowNs) const
+{
+    if (m_homingId != 0)
+        return true;
+    if (m_segments.isEmpty())
+        return false;
+
+    int segment;
+    double t;
+    locate(nowNs ? nowNs : LinkStatistics::nowNs(), segment, t);
+    return segment >= 0;
+}
+
+void PositionEstimator::queueLine(quint64 id, const QByteArray &line, qint64 nowNs)
+{
+    if (nowNs == 0)
+        nowNs = LinkStatistics::nowNs();
+
+    Words words;
+    parseWords(line, words);
+    const char axes[3] = {'X', 'Y', 'Z'};
+
+    if (words.contains('M'))
+    {
+        const int code = int(words['M']);
+        if (code == 112 || code == 410)
+            stop(nowNs);
+        return;
+    }
+    if (!words.contains('G'))
+        return;
+
+    switch (int(words['G']))
+    {
+    case 0:
+    case 1:
+    {
+        if (words.contains('F') && words['F'] > 0.0)
+            m_feedrate = words['F'];
+
+        Segment segment;
+        segment.id = id;
+        segment.feedrate = m_feedrate;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            segment.to[axis] = m_commanded[axis];
+            if (words.contains(axes[axis]))
+                segment.to[axis] = m_relative ? m_commanded[axis] + words[axes[axis]] : words[axes[axis]];
+        }
+        // Same threshold as MotionPlanner::addMove(), so segment indices match
+        if (distance(segment.to, m_commanded) < 1e-9)
+            return;
+
+        prune(nowNs);
+        if (m_segments.isEmpty() && m_homingId == 0)
+        {
+            // Starting from rest now; the first report moves the start to when it really began
+            m_startNs = nowNs;
+            m_startSpeed = 0.0;
+        }
+        m_segments.append(segment);
+        std::copy(segment.to, segment.to + 3, m_commanded);
+        m_planned = false;
+        break;
+    }
+    case 28:
+    {
+        // Moves queued before the G28 are dropped from the model; the homing
+        // path itself is unknown, so reports are shown as they come in
+        const PositionEstimate current = estimate(nowNs);
+        m_segments.clear();
+        std::copy(current.pos, current.pos + 3, m_start);
+        const bool all = !words.contains('X') && !words.contains('Y') && !words.contains('Z');
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            m_homedAxes[axis] = all || words.contains(axes[axis]);
+            m_commanded[axis] = m_homedAxes[axis] ? 0.0 : current.pos[axis];
+        }
+        m_homingId = id;
+        m_planned = true;
+        break;
+    }
+    case 90:
+        m_relative = false;
+        break;
+    case 91:
+        m_relative = true;
+        break;
+    case 92:
+    {
+        // Redefines coordinates; moves queued before it are in the old ones,
+        // so the model restarts from the estimate (this is rare outside the
+        // start of a program)
+        PositionEstimate current = estimate(nowNs);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (words.contains(axes[axis]))
+                current.pos[axis] = words[axes[axis]];
+        }
+        m_segments.clear();
+        restart(current.pos, nowNs);
+        std::copy(current.pos, current.pos + 3, m_commanded);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void PositionEstimator::applyReport(const MotorPosition &pos)
+{
+    const qint64 t = pos.timestampNs ? pos.timestampNs : LinkStatistics::nowNs();
+    const double reported[3] = {pos.x, pos.y, pos.z};
+
+    if (m_homingId != 0)
+    {
+        std::copy(reported, reported + 3, m_start);
+        m_lastCorrection = 0.0;
+        return;
+    }
+
+    prune(t);
+    const PositionEstimate current = estimate(t);
+    m_lastCorrection = distance(reported, current.pos);
+
+    if (m_segments.isEmpty())
+    {
+        // At rest: the report is the position, and the base for the next move
+        std::copy(reported, reported + 3, m_start);
+        std::copy(reported, reported + 3, m_commanded);
+        return;
+    }
+
+    // Nearest point on the path around the current segment; the earliest
+    // wins a tie, so a path that doubles back is not skipped ahead
+    int segment;
+    double inSegment;
+    locate(t, segment, inSegment);
+    if (segment < 0)
+        segment = m_segments.size() - 1;
+    const int first = qMax(0, segment - 1);
+    const int last = qMin(int(m_segments.size()) - 1, segment + SearchAhead);
+
+    int best = first;
+    double bestDistance = HUGE_VAL;
+    double bestAlong = 0.0;
+    for (int j = first; j <= last; ++j)
+    {
+        const double length = m_planner.segmentLength(j);
+        double from[3];
+        double unit[3];
+        double along = 0.0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            from[axis] = segmentStart(j, axis);
+            unit[axis] = (m_segments[j].to[axis] - from[axis]) / length;
+            along += (reported[axis] - from[axis]) * unit[axis];
+        }
+        along = std::clamp(along, 0.0, length);
+
+        double onPath[3];
+        for (int axis = 0; axis < 3; ++axis)
+            onPath[axis] = from[axis] + unit[axis] * along;
+        const double d = distance(reported, onPath);
+        if (d < bestDistance - 1e-6)
+        {
+            best = j;
+            bestDistance = d;
+            bestAlong = along;
+        }
+    }
+
+    if (bestDistance > OffPathTolerance)
+    {
+        // Not where any queued move goes (a move this estimator did not see,
+        // a skipped step): continue the remaining moves from the report
+        m_segments.remove(0, best);
+        restart(reported, t);
+        return;
+    }
+
+    // Shift the timeline so the estimate passes through the report at t
+    double elapsed = m_planner.timeAt(best, bestAlong);
+    for (int j = 0; j < best; ++j)
+        elapsed += m_planner.segmentTime(j);
+    m_startNs = t - qint64(elapsed * 1e9);
+}
+
+void PositionEstimator::commandCompleted(quint64 id, qint64 nowNs)
+{
+    if (id == 0 || id != m_homingId)
+        return;
+
+    // Marlin acknowledges G28 once homing is done
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (m_homedAxes[axis])
+            m_start[axis] = 0.0;
+    }
+    m_homingId = 0;
+    restart(m_start, nowNs ? nowNs : LinkStatistics::nowNs());
+}
+
+void PositionEstimator::commandFailed(quint64 id, qint64 nowNs)
+{
+    if (id == 0)
+        return;
+    if (nowNs == 0)
+        nowNs = LinkStatistics::nowNs();
+
+    if (id == m_homingId)
+    {
+        // Homing was aborted somewhere; the last report is all there is
+        m_homingId = 0;
+        restart(m_start, nowNs);
+        return;
+    }
+
+    prune(nowNs);
+    int index = -1;
+    for (int i = 0; i < m_segments.size(); ++i)
+    {
+        if (m_segments[i].id == id)
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0)
+        return;
+
+    // A failed move is taken as not executed. If it was the one under way,
+    // the machine is held where the estimate had got to.
+    const PositionEstimate current = estimate(nowNs);
+    m_segments.remove(index);
+    if (index == 0)
+        restart(current.pos, nowNs);
+    else
+        dropEmptySegments();
+
+    const double *end = m_segments.isEmpty() ? m_start : m_segments.last().to;
+    std::copy(end, end + 3, m_commanded);
+}
+
+void PositionEstimator::stop(qint64 nowNs)
+{
+    if (nowNs == 0)
+        nowNs = LinkStatistics::nowNs();
+
+    const PositionEstimate current = estimate(nowNs);
+    m_segments.clear();
+    m_homingId = 0;
+    restart(current.pos, nowNs);
+    std::copy(current.pos, current.pos + 3, m_commanded);
+}
+
+void PositionEstimator::ensurePlanned() const
+{
+    if (m_planned)
+        return;
+
+    m_planner.clear();
+    m_planner.reserve(m_segments.size());
+    m_planner.setStartPosition(m_start[0], m_start[1], m_start[2]);
+    m_planner.setStartSpeed(m_startSpeed);
+    for (const Segment &segment : m_segments)
+        m_planner.addMove(segment.to[0], segment.to[1], segment.to[2], segment.feedrate);
+    m_planner.plan();
+    m_planned = true;
+}
+
+void PositionEstimator::locate(qint64 nowNs, int &segment, double &t) const
+{
+    ensurePlanned();
+    double elapsed = double(nowNs - m_startNs) / 1e9;
+    if (elapsed <= 0.0)
+    {
+        segment = 0;
+        t = 0.0;
+        return;
+    }
+
+    const int count = m_planner.segmentCount();
+    for (int i = 0; i < count; ++i)
+    {
+        const double time = m_planner.segmentTime(i);
+        if (elapsed < time)
+        {
+            segment = i;
+            t = elapsed;
+            return;
+        }
+        elapsed -= time;
+    }
+    segment = -1; // Past the end of the path
+    t = 0.0;
+}
+
+double PositionEstimator::segmentStart(int segment, int axis) const
+{
+    return segment == 0 ? m_start[axis] : m_segments[segment - 1].to[axis];
+}
+
+void PositionEstimator::prune(qint64 nowNs)
+{
+    if (m_segments.isEmpty() || m_homingId != 0)
+        return;
+
+    ensurePlanned();
+    double elapsed = double(nowNs - m_startNs) / 1e9;
+    double doneTime = 0.0;
+    int done = 0;
+    while (done < m_segments.size() && elapsed >= m_planner.segmentTime(done))
+    {
+        elapsed -= m_planner.segmentTime(done);
+        doneTime += m_planner.segmentTime(done);
+        ++done;
+    }
+    if (done == 0)
+        return;
+
+    // The rest of the path is replanned from the speed it had reached
+    const Segment &lastDone = m_segments[done - 1];
+    std::copy(lastDone.to, lastDone.to + 3, m_start);
+    m_startSpeed = done < m_segments.size() ? m_planner.entrySpeed(done) : 0.0;
+    m_startNs += qint64(doneTime * 1e9);
+    m_segments.remove(0, done);
+    m_planned = m_segments.isEmpty();
+}
+
+void PositionEstimator::restart(const double pos[3], qint64 nowNs)
+{
+    std::copy(pos, pos + 3, m_start);
+    m_startNs = nowNs;
+    m_startSpeed = 0.0;
+
+    dropEmptySegments();
+}
+
+void PositionEstimator::dropEmptySegments()
+{
+    // A move ending where the previous one ends is skipped by the planner;
+    // kept here, it would shift every later planner index
+    const double *from = m_start;
+    for (int i = 0; i < m_segments.size();)
+    {
+        if (distance(m_segments[i].to, from) < 1e-9)
+        {
+            m_segments.remove(i);
+            continue;
+        }
+        from = m_segments[i].to;
+        ++i;
+    }
+    m_planned = m_segments.isEmpty();
+}
@@ -0,0 +1,95 @@
+// PositionEstimator.h
+#ifndef POSITIONESTIMATOR_H
+#define POSITIONESTIMATOR_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include "MotionPlanner.h"
+
+class TinyBeeController;
+struct MotorPosition;
+
+// Position and velocity at one instant
+struct PositionEstimate
+{
+    double pos[3] = {0.0, 0.0, 0.0};      // mm
+    double velocity[3] = {0.0, 0.0, 0.0}; // mm/s
+    bool moving = false;
+};
+
+// Dead reckoning between position reports. Every move the controller queues
+// joins a timeline planned with MotionPlanner (the firmware's limits and
+// junction model), so estimate() interpolates along the commanded path with
+// acceleration. Each report re-anchors the timeline: the reported position is
+// projected onto the path and the timeline shifted so the estimate passes
+// through it at the report's timestamp. A report off the path restarts the
+// remaining moves from where the machine actually is.
+//
+// Reports are taken as the machine's actual position: M154 auto-reports, the
+// controller's "M114 R" polls on Marlin built with M114_REALTIME, and the
+// simulator. Stock Marlin ignores the R and reports the planned destination;
+// the estimate then settles on the end of the queued path at each report,
+// which is what the display showed before.
+class PositionEstimator : public QObject
+{
+    Q_OBJECT
+public:
+    // With a controller, queued lines, failures and reports are followed
+    // automatically; without one, feed queueLine() and applyReport()
+    explicit PositionEstimator(TinyBeeController *controller = nullptr, QObject *parent = nullptr);
+
+    void setLimits(const MotionLimits &limits);
+
+    // Times use the LinkStatistics::nowNs() clock; 0 = now
+    PositionEstimate estimate(qint64 nowNs = 0) const;
+    bool isMoving(qint64 nowNs = 0) const;
+    // Where the queued moves end: the base for relative targets and step moves
+    double commandedPosition(int axis) const { return m_commanded[axis]; }
+    // Estimate error found by the last report (mm)
+    double lastCorrection() const { return m_lastCorrection; }
+    int pendingSegments() const { return m_segments.size(); }
+
+    void queueLine(quint64 id, const QByteArray &line, qint64 nowNs = 0);
+    void applyReport(const MotorPosition &pos);
+    void commandCompleted(quint64 id, qint64 nowNs = 0);
+    void commandFailed(quint64 id, qint64 nowNs = 0);
+    // Motion stopped where it is (M112, M410); the queued moves are dropped
+    void stop(qint64 nowNs = 0);
+
+private:
+    struct Segment
+    {
+        quint64 id = 0;
+        double to[3];
+        double feedrate = 0.0; // mm/min
+    };
+
+    // Replanned lazily, so a batch of queued lines costs one plan
+    mutable MotionPlanner m_planner;
+    mutable bool m_planned = true;
+
+    QVector<Segment> m_segments; // Not yet completed, in execution order
+    double m_start[3] = {0.0, 0.0, 0.0}; // Where m_segments.first() starts (or the rest position)
+    qint64 m_startNs = 0;                // When it starts
+    double m_startSpeed = 0.0;           // mm/s
+
+    double m_commanded[3] = {0.0, 0.0, 0.0};
+    double m_feedrate = 1000.0; // Modal F, mm/min
+    bool m_relative = false;
+
+    // While homing, the path is unknown; the last report is shown until the
+    // G28 is acknowledged
+    quint64 m_homingId = 0;
+    bool m_homedAxes[3] = {false, false, false};
+    double m_lastCorrection = 0.0;
+
+    void ensurePlanned() const;
+    void locate(qint64 nowNs, int &segment, double &t) const;
+    double segmentStart(int segment, int axis) const;
+    void prune(qint64 nowNs);
+    void restart(const double pos[3], qint64 nowNs);
+    void dropEmptySegments();
+};
+
+#endif // POSITIONESTIMATOR_H
@@ -0,0 +1,119 @@
+// PositionParser.cpp
+#include "PositionParser.h"
+#include "TinybeeController.h"
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// Parses a number at p (optional leading '+' and spaces allowed); advances p past it
+bool parseNumber(const char *&p, const char *end, double &value)
+{
+    while (p < end && isSpace(*p))
+        ++p;
+    if (p < end && *p == '+')
+        ++p;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+        return false;
+    p = result.ptr;
+    return true;
+}
+} // namespace
+
+bool parsePositionReport(std::string_view line, MotorPosition &pos)
+{
+    const char *p = line.data();
+    const char *end = p + line.size();
+
+    MotorPosition parsed = pos;
+    parsed.hasCounts = false;
+    bool inCounts = false;
+    int found = 0; // Bit per axis: X=1, Y=2, Z=4
+
+    while (p < end)
+    {
+        while (p < end && isSpace(*p))
+            ++p;
+        if (p >= end)
+            break;
+
+        // "Count" separates logical positions from stepper counts
+        if (end - p >= 5 && std::string_view(p, 5) == "Count")
+        {
+            inCounts = true;
+            p += 5;
+            continue;
+        }
+
+        if (end - p >= 2 && p[1] == ':')
+        {
+            char axis = p[0];
+            const char *value = p + 2;
+            double number;
+            if (parseNumber(value, end, number))
+            {
+                p = value;
+                if (!inCounts)
+                {
+                    switch (axis)
+                    {
+                    case 'X':
+                        parsed.x = number;
+                        found |= 1;
+                        break;
+                    case 'Y':
+                        parsed.y = number;
+                        found |= 2;
+                        break;
+                    case 'Z':
+                        parsed.z = number;
+                        found |= 4;
+                        break;
+                    case 'E':
+                        parsed.e = number;
+                        break;
+                    }
+                }
+                else
+                {
+                    // CoreXY firmware reports A/B counts instead of X/Y
+                    switch (axis)
+                    {
+                    case 'X':
+                    case 'A':
+                        parsed.countX = std::llround(number);
+                        parsed.hasCounts = true;
+                        break;
+                    case 'Y':
+                    case 'B':
+                        parsed.countY = std::llround(number);
+                        parsed.hasCounts = true;
+                        break;
+                    case 'Z':
+                    case 'C':
+                        parsed.countZ = std::llround(number);
+                        parsed.hasCounts = true;
+                        break;
+                    }
+                }
+                continue;
+            }
+        }
+
+        // Unknown token: skip to the next separator
+        while (p < end && !isSpace(*p))
+            ++p;
+    }
+
+    if (found != 7)
+        return false;
+
+    pos = parsed;
+    return true;
+}
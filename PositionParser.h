@@ -0,0 +1,15 @@
+// PositionParser.h
+#ifndef POSITIONPARSER_H
+#define POSITIONPARSER_H
+
+#include <string_view>
+
+struct MotorPosition;
+
+// Parses a Marlin position report (M114 reply or M154 auto-report), e.g.
+//   "X:10.00 Y:15.00 Z:5.00 E:0.00 Count X:1000 Y:1500 Z:500"
+// in a single pass with std::from_chars and no allocation. Returns false and
+// leaves pos untouched unless X, Y and Z were all found before "Count".
+bool parsePositionReport(std::string_view line, MotorPosition &pos);
+
+#endif // POSITIONPARSER_H
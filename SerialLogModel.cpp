@@ -0,0 +1,233 @@
+// SerialLogModel.cpp
+#include "SerialLogModel.h"
+#include <QBrush>
+#include <QColor>
+#include <QTime>
+#include <algorithm>
+#include <cstring>
+
+SerialLogModel::SerialLogModel(int maxEntries, int arenaBytes, QObject *parent)
+    : QAbstractListModel(parent),
+      m_records(size_t(qMax(16, maxEntries))),
+      m_arena(size_t(qMax(4 * MaxPayload, arenaBytes))),
+      m_visible(m_records.size())
+{
+}
+
+SerialLogModel::Entry SerialLogModel::makeEntry(Direction direction, Severity severity, const QString &text)
+{
+    Entry entry;
+    entry.timeMs = QTime::currentTime().msecsSinceStartOfDay();
+    entry.direction = direction;
+    entry.severity = severity;
+    entry.text = text;
+    return entry;
+}
+
+void SerialLogModel::append(Direction direction, Severity severity, const QString &text)
+{
+    appendBatch(QVector<Entry>{makeEntry(direction, severity, text)});
+}
+
+int SerialLogModel::placePayload(int length, int writePos, bool *wrapped) const
+{
+    // Payloads are stored contiguously; wrap to the start when the tail is too short
+    *wrapped = writePos + length > int(m_arena.size());
+    return *wrapped ? 0 : writePos;
+}
+
+int SerialLogModel::appendBatch(const QVector<Entry> &entries)
+{
+    // Keep only the newest entries that fit in half the arena and in the record
+    // ring, so entries of one batch never overwrite each other
+    QVector<QByteArray> payloads;
+    payloads.reserve(entries.size());
+    int first = entries.size();
+    qint64 batchBytes = 0;
+    while (first > 0 && entries.size() - first < maxEntries())
+    {
+        QByteArray payload = entries[first - 1].text.toUtf8();
+        if (payload.size() > MaxPayload)
+            payload.truncate(MaxPayload);
+        if (batchBytes + payload.size() > qint64(m_arena.size() / 2))
+            break;
+        batchBytes += payload.size();
+        payloads.append(payload);
+        --first;
+    }
+    std::reverse(payloads.begin(), payloads.end());
+    const int dropped = first;
+
+    // Work out which of the oldest records the batch will overwrite. Records
+    // are laid out in arena order, so the overlap is always at the front.
+    quint64 evictUntil = m_firstSeq;
+    int evictedVisible = 0;
+    int writePos = m_writePos;
+    int added = 0;
+    int addedVisible = 0;
+    for (int i = 0; i < payloads.size(); ++i)
+    {
+        const QByteArray &payload = payloads[i];
+        if (payload.isEmpty())
+            continue;
+
+        bool wrapped = false;
+        const int start = placePayload(payload.size(), writePos, &wrapped);
+        while (evictUntil != m_nextSeq)
+        {
+            const Record &oldest = m_records[evictUntil % m_records.size()];
+            const int oldBegin = int(oldest.offset);
+            const int oldEnd = oldBegin + oldest.length;
+            const bool inSkippedTail = wrapped && oldBegin >= writePos;
+            const bool overlaps = oldBegin < start + payload.size() && oldEnd > start;
+            const bool ringFull = (m_nextSeq - evictUntil) + quint64(added) >= m_records.size();
+            if (!inSkippedTail && !overlaps && !ringFull)
+                break;
+            if (!oldest.chatter)
+                ++evictedVisible;
+            ++evictUntil;
+        }
+        writePos = start + payload.size();
+        ++added;
+        if (!isChatter(entries[first + i].direction, payload))
+            ++addedVisible;
+    }
+
+    // Drop the overwritten records
+    const int removed = m_hideChatter ? evictedVisible : int(evictUntil - m_firstSeq);
+    if (removed > 0)
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+    m_visibleFirst = int((m_visibleFirst + evictedVisible) % m_visible.size());
+    m_visibleCount -= evictedVisible;
+    m_firstSeq = evictUntil;
+    if (removed > 0)
+        endRemoveRows();
+
+    // Store the new ones; non-chatter records are also tracked in m_visible so
+    // filtering can be toggled without rescanning the log
+    const int inserted = m_hideChatter ? addedVisible : added;
+    const int row = rowCount();
+    if (inserted > 0)
+        beginInsertRows(QModelIndex(), row, row + inserted - 1);
+
+    for (int i = 0; i < payloads.size(); ++i)
+    {
+        const QByteArray &payload = payloads[i];
+        if (payload.isEmpty())
+            continue;
+
+        const Entry &entry = entries[first + i];
+        bool wrapped = false;
+        const int start = placePayload(payload.size(), m_writePos, &wrapped);
+        std::memcpy(m_arena.data() + start, payload.constData(), size_t(payload.size()));
+        m_writePos = start + payload.size();
+
+        Record record;
+        record.timeMs = entry.timeMs;
+        record.offset = quint32(start);
+        record.length = quint16(payload.size());
+        record.direction = quint8(entry.direction);
+        record.severity = quint8(entry.severity);
+        record.chatter = isChatter(entry.direction, payload);
+
+        const quint64 seq = m_nextSeq++;
+        m_records[seq % m_records.size()] = record;
+        if (!record.chatter)
+        {
+            m_visible[(m_visibleFirst + m_visibleCount) % m_visible.size()] = seq;
+            ++m_visibleCount;
+        }
+    }
+
+    if (inserted > 0)
+        endInsertRows();
+
+    return dropped;
+}
+
+void SerialLogModel::clear()
+{
+    beginResetModel();
+    m_firstSeq = m_nextSeq;
+    m_writePos = 0;
+    m_visibleFirst = 0;
+    m_visibleCount = 0;
+    endResetModel();
+}
+
+void SerialLogModel::setHideChatter(bool hide)
+{
+    if (hide == m_hideChatter)
+        return;
+    beginResetModel();
+    m_hideChatter = hide;
+    endResetModel();
+}
+
+const SerialLogModel::Record &SerialLogModel::recordAt(int row) const
+{
+    if (m_hideChatter)
+        return m_records[m_visible[(m_visibleFirst + row) % m_visible.size()] % m_records.size()];
+    return m_records[(m_firstSeq + quint64(row)) % m_records.size()];
+}
+
+int SerialLogModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_hideChatter ? m_visibleCount : totalEntries();
+}
+
+QVariant SerialLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rowCount())
+        return QVariant();
+
+    const Record &record = recordAt(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    {
+        const QString timestamp = QTime::fromMSecsSinceStartOfDay(record.timeMs).toString("hh:mm:ss");
+        const QString text = QString::fromUtf8(m_arena.data() + record.offset, record.length);
+        if (record.direction == Tx)
+            return QString("[%1] TX: %2").arg(timestamp, text);
+        if (record.direction == Rx)
+            return QString("[%1] RX: %2").arg(timestamp, text);
+        return QString("[%1] %2").arg(timestamp, text);
+    }
+    case Qt::ForegroundRole:
+        if (record.direction == Tx)
+            return QBrush(QColor("orange"));
+        if (record.direction == Info)
+            return QBrush(Qt::black);
+        switch (record.severity)
+        {
+        case Ok:
+            return QBrush(QColor("green"));
+        case Error:
+            return QBrush(Qt::red);
+        case Comment:
+            return QBrush(Qt::gray);
+        default:
+            return QBrush(Qt::blue);
+        }
+    case DirectionRole:
+        return int(record.direction);
+    case SeverityRole:
+        return int(record.severity);
+    case ChatterRole:
+        return record.chatter;
+    default:
+        return QVariant();
+    }
+}
+
+bool SerialLogModel::isChatter(Direction direction, const QByteArray &payload)
+{
+    if (direction == Tx)
+        return payload.startsWith("M114");
+    if (direction == Rx)
+        return payload == "ok" || payload.startsWith("X:");
+    return false;
+}
@@ -0,0 +1,99 @@
+// SerialLogModel.h
+#ifndef SERIALLOGMODEL_H
+#define SERIALLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <vector>
+
+// Serial monitor log with constant memory. Entries are compact fixed-size
+// records in a ring; their text lives in a separate circular byte arena. When
+// either is full the oldest entries are dropped. Row text and colors are only
+// produced in data(), so a view with uniform item sizes formats just the rows
+// on screen.
+class SerialLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Direction
+    {
+        Info,
+        Tx,
+        Rx
+    };
+
+    enum Severity
+    {
+        Normal,
+        Ok,
+        Error,
+        Comment
+    };
+
+    enum Roles
+    {
+        DirectionRole = Qt::UserRole + 1,
+        SeverityRole,
+        ChatterRole // Position polls and their acknowledgements
+    };
+
+    struct Entry
+    {
+        qint32 timeMs = 0; // Milliseconds since midnight
+        Direction direction = Info;
+        Severity severity = Normal;
+        QString text;
+    };
+
+    explicit SerialLogModel(int maxEntries = 5000, int arenaBytes = 256 * 1024, QObject *parent = nullptr);
+
+    static Entry makeEntry(Direction direction, Severity severity, const QString &text);
+
+    void append(Direction direction, Severity severity, const QString &text);
+    // Adds all entries with one row insertion (and at most one removal) so
+    // attached views relayout once per batch. Returns the number of entries
+    // dropped because the batch alone exceeds the log's capacity.
+    int appendBatch(const QVector<Entry> &entries);
+    void clear();
+
+    // Hides M114 polls, position reports and bare "ok" lines
+    void setHideChatter(bool hide);
+    bool hideChatter() const { return m_hideChatter; }
+
+    int totalEntries() const { return int(m_nextSeq - m_firstSeq); }
+    int maxEntries() const { return int(m_records.size()); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    static constexpr int MaxPayload = 1024; // Longer lines are truncated
+
+private:
+    struct Record
+    {
+        qint32 timeMs = 0;  // Milliseconds since midnight
+        quint32 offset = 0; // Payload position in m_arena
+        quint16 length = 0;
+        quint8 direction = Info;
+        quint8 severity = Normal;
+        bool chatter = false;
+    };
+
+    std::vector<Record> m_records;
+    std::vector<char> m_arena;
+    quint64 m_firstSeq = 0; // Oldest live record
+    quint64 m_nextSeq = 0;
+    int m_writePos = 0; // Next free byte in m_arena
+
+    // Sequence numbers of non-chatter records, used as rows while filtering
+    std::vector<quint64> m_visible;
+    int m_visibleFirst = 0;
+    int m_visibleCount = 0;
+    bool m_hideChatter = false;
+
+    const Record &recordAt(int row) const;
+    int placePayload(int length, int writePos, bool *wrapped) const;
+    static bool isChatter(Direction direction, const QByteArray &payload);
+};
+
+#endif // SERIALLOGMODEL_H
@@ -0,0 +1,212 @@
+// SerialSession.cpp
+#include "SerialSession.h"
+#include "LinkStatistics.h"
+#include <QDateTime>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+constexpr char FileMagic[8] = {'T', 'B', 'S', 'E', 'S', 'S', '0', '1'};
+constexpr int FileHeaderSize = 16;
+constexpr int RecordHeaderSize = 16;
+} // namespace
+
+bool SerialSessionWriter::open(const QString &path, QString *error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        if (error)
+            *error = m_file.errorString();
+        return false;
+    }
+
+    char header[FileHeaderSize];
+    const qint64 wallMs = QDateTime::currentMSecsSinceEpoch();
+    std::memcpy(header, FileMagic, sizeof(FileMagic));
+    std::memcpy(header + 8, &wallMs, sizeof(wallMs));
+    m_file.write(header, sizeof(header));
+
+    m_startNs = LinkStatistics::nowNs();
+    m_bytes = 0;
+    return true;
+}
+
+void SerialSessionWriter::close()
+{
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+void SerialSessionWriter::record(SerialSessionRecord::Direction direction, const char *data, qint64 size)
+{
+    if (!m_file.isOpen() || size <= 0)
+        return;
+
+    char header[RecordHeaderSize] = {};
+    const qint64 timeNs = LinkStatistics::nowNs() - m_startNs;
+    const quint32 length = quint32(size);
+    std::memcpy(header, &timeNs, sizeof(timeNs));
+    header[8] = char(direction);
+    std::memcpy(header + 12, &length, sizeof(length));
+
+    // QFile buffers, so this is a memcpy most of the time
+    m_file.write(header, sizeof(header));
+    m_file.write(data, size);
+    m_bytes += size;
+}
+
+SerialReplayDevice::SerialReplayDevice(QObject *parent)
+    : QIODevice(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &SerialReplayDevice::advance);
+}
+
+bool SerialReplayDevice::load(const QString &path, QVector<SerialSessionRecord> &records, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    const QByteArray data = file.readAll();
+    if (data.size() < FileHeaderSize || std::memcmp(data.constData(), FileMagic, sizeof(FileMagic)) != 0)
+    {
+        if (error)
+            *error = "Not a recorded serial session";
+        return false;
+    }
+
+    records.clear();
+    const char *p = data.constData();
+    qint64 pos = FileHeaderSize;
+    // A capture cut short ends in a partial record; everything before it is kept
+    while (pos + RecordHeaderSize <= data.size())
+    {
+        SerialSessionRecord record;
+        quint32 length;
+        std::memcpy(&record.timeNs, p + pos, sizeof(record.timeNs));
+        std::memcpy(&length, p + pos + 12, sizeof(length));
+        if (pos + RecordHeaderSize + qint64(length) > data.size())
+            break;
+        record.direction = p[pos + 8] == SerialSessionRecord::Tx ? SerialSessionRecord::Tx : SerialSessionRecord::Rx;
+        record.data = QByteArray(p + pos + RecordHeaderSize, int(length));
+        records.append(record);
+        pos += RecordHeaderSize + qint64(length);
+    }
+    return true;
+}
+
+bool SerialReplayDevice::loadFile(const QString &path, QString *error)
+{
+    m_next = 0;
+    return load(path, m_records, error);
+}
+
+bool SerialReplayDevice::open(OpenMode mode)
+{
+    // Unbuffered: bytes are already held in m_rx, and readyRead() must only
+    // fire when new ones are released
+    if (!QIODevice::open(mode | QIODevice::Unbuffered))
+        return false;
+
+    m_next = 0;
+    m_rx.clear();
+    m_rxHead = 0;
+    m_clock.start();
+    m_timer.start(0);
+    return true;
+}
+
+void SerialReplayDevice::close()
+{
+    m_timer.stop();
+    m_rx.clear();
+    m_rxHead = 0;
+    QIODevice::close();
+}
+
+qint64 SerialReplayDevice::bytesAvailable() const
+{
+    return qint64(m_rx.size() - m_rxHead) + QIODevice::bytesAvailable();
+}
+
+qint64 SerialReplayDevice::readData(char *data, qint64 maxSize)
+{
+    const qint64 n = qMin(maxSize, qint64(m_rx.size() - m_rxHead));
+    std::memcpy(data, m_rx.constData() + m_rxHead, size_t(n));
+    m_rxHead += int(n);
+    if (m_rxHead == m_rx.size())
+    {
+        m_rx.clear();
+        m_rxHead = 0;
+    }
+    return n;
+}
+
+qint64 SerialReplayDevice::writeData(const char *, qint64 size)
+{
+    return size; // The recorded TX stream stands in for whatever is sent now
+}
+
+void SerialReplayDevice::advance()
+{
+    if (!isOpen())
+        return;
+
+    const bool unpaced = m_speed <= 0.0;
+    const qint64 position = unpaced ? std::numeric_limits<qint64>::max()
+                                    : qint64(double(m_clock.nsecsElapsed()) * m_speed);
+
+    qint64 released = 0;
+    bool rxReleased = false;
+    while (m_next < m_records.size() && m_records[m_next].timeNs <= position)
+    {
+        if (unpaced && released >= MaxBurstBytes)
+            break;
+
+        const SerialSessionRecord &record = m_records[m_next++];
+        if (record.direction == SerialSessionRecord::Rx)
+        {
+            // Drop what was read already before growing the buffer
+            if (m_rxHead > 0)
+            {
+                m_rx.remove(0, m_rxHead);
+                m_rxHead = 0;
+            }
+            m_rx.append(record.data);
+            rxReleased = true;
+        }
+        else
+        {
+            emit txReplayed(record.data);
+        }
+        released += record.data.size();
+    }
+
+    if (rxReleased)
+        emit readyRead();
+
+    if (m_next == m_records.size())
+    {
+        emit replayFinished();
+        return;
+    }
+
+    if (unpaced)
+    {
+        m_timer.start(0);
+        return;
+    }
+
+    // Long idle gaps in the recording are waited out in steps of at most a second
+    const double waitMs = double(m_records[m_next].timeNs - position) / m_speed / 1e6;
+    m_timer.start(int(qBound(0.0, waitMs, 1000.0)));
+}
@@ -0,0 +1,99 @@
+// SerialSession.h
+#ifndef SERIALSESSION_H
+#define SERIALSESSION_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+
+// Raw serial traffic of one session: every chunk of bytes read from or
+// written to the port, stamped with the time since the capture started.
+//
+// File layout (little endian):
+//   header  16 bytes: "TBSESS01", wall clock at start (ms since epoch, i64)
+//   record  t_ns i64, direction u8, 3 bytes padding, length u32, data
+struct SerialSessionRecord
+{
+    enum Direction
+    {
+        Rx,
+        Tx
+    };
+
+    qint64 timeNs = 0; // Since the start of the capture
+    Direction direction = Rx;
+    QByteArray data;
+};
+
+// Appends records to a session file. Used on the serial worker's thread,
+// right where the bytes cross the port.
+class SerialSessionWriter
+{
+public:
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    void record(SerialSessionRecord::Direction direction, const char *data, qint64 size);
+    qint64 bytesRecorded() const { return m_bytes; }
+
+private:
+    QFile m_file;
+    qint64 m_startNs = 0;
+    qint64 m_bytes = 0;
+};
+
+// Serial port stand-in that plays a recorded session back. Recorded RX bytes
+// become readable (with readyRead()) at their original time divided by the
+// speed factor; recorded TX bytes are announced through txReplayed() so they
+// can be shown like sent lines. Anything written to the device is accepted
+// and discarded. A speed of 0 replays as fast as the reader keeps up, handing
+// out at most MaxBurstBytes per event-loop turn so the loop stays responsive.
+class SerialReplayDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit SerialReplayDevice(QObject *parent = nullptr);
+
+    static bool load(const QString &path, QVector<SerialSessionRecord> &records, QString *error = nullptr);
+
+    bool loadFile(const QString &path, QString *error = nullptr);
+    void setSpeed(double speed) { m_speed = speed; }
+    double speed() const { return m_speed; }
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+    int recordCount() const { return m_records.size(); }
+    int recordsReplayed() const { return m_next; }
+    qint64 durationNs() const { return m_records.isEmpty() ? 0 : m_records.last().timeNs; }
+
+    static constexpr qint64 MaxBurstBytes = 64 * 1024;
+
+signals:
+    void txReplayed(const QByteArray &data);
+    void replayFinished();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private slots:
+    void advance();
+
+private:
+    QVector<SerialSessionRecord> m_records;
+    int m_next = 0;
+    double m_speed = 1.0;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+
+    QByteArray m_rx; // Released but not yet read
+    int m_rxHead = 0;
+};
+
+#endif // SERIALSESSION_H
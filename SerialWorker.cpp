@@ -0,0 +1,756 @@
+// SerialWorker.cpp
+#include "SerialWorker.h"
+#include "PositionParser.h"
+#include <QDebug>
+
+SerialWorker::SerialWorker(SpscQueue<SerialRequest> *requests, SpscQueue<SerialEvent> *events,
+                           std::atomic<bool> *requestWakePending, std::atomic<bool> *eventWakePending,
+                           QObject *eventReceiver)
+    : QObject(nullptr),
+      m_requests(requests),
+      m_events(events),
+      m_requestWakePending(requestWakePending),
+      m_eventWakePending(eventWakePending),
+      m_eventReceiver(eventReceiver),
+      m_serial(new QSerialPort(this)),
+      m_port(m_serial),
+      m_ackTimer(new QTimer(this)),
+      m_eventRetryTimer(new QTimer(this)),
+      m_writeFlushTimer(new QTimer(this))
+{
+    m_ackTimer->setSingleShot(true);
+    m_eventRetryTimer->setSingleShot(true);
+    m_eventRetryTimer->setInterval(5);
+    m_writeFlushTimer->setSingleShot(true);
+    m_writeFlushTimer->setInterval(0);
+    m_clock.start();
+    m_stats.reset();
+
+    connect(m_serial, &QSerialPort::readyRead, this, &SerialWorker::onReadyRead);
+    connect(m_serial, &QSerialPort::errorOccurred, this, &SerialWorker::onErrorOccurred);
+    connect(m_ackTimer, &QTimer::timeout, this, &SerialWorker::onAckTimeout);
+    connect(m_eventRetryTimer, &QTimer::timeout, this, &SerialWorker::flushEvents);
+    connect(m_writeFlushTimer, &QTimer::timeout, this, &SerialWorker::flushWrites);
+}
+
+bool SerialWorker::openPort(const QString &portName, qint32 baudRate, QString *error)
+{
+    if (m_port->isOpen())
+        closePort("Port reopened");
+
+    m_serial->setPortName(portName);
+    m_serial->setBaudRate(baudRate);
+    m_serial->setDataBits(QSerialPort::Data8);
+    m_serial->setParity(QSerialPort::NoParity);
+    m_serial->setStopBits(QSerialPort::OneStop);
+    m_serial->setFlowControl(QSerialPort::NoFlowControl);
+
+    if (!m_serial->open(QIODevice::ReadWrite))
+    {
+        if (error)
+            *error = m_serial->errorString();
+        return false;
+    }
+
+    // Clear buffers for clean start
+    m_framer.clear();
+    m_serial->clear(QSerialPort::AllDirections);
+    m_port = m_serial;
+    resetLineNumbering();
+    return true;
+}
+
+void SerialWorker::closePort(const QString &reason)
+{
+    failAll(reason);
+    if (m_port->isOpen())
+        m_port->close();
+
+    if (m_replay)
+    {
+        // May be closing from inside one of the device's own signals
+        m_replay->deleteLater();
+        m_replay = nullptr;
+        m_port = m_serial;
+    }
+}
+
+bool SerialWorker::openReplay(const QString &path, double speed, QString *error)
+{
+    if (m_port->isOpen())
+        closePort("Port reopened");
+
+    SerialReplayDevice *replay = new SerialReplayDevice(this);
+    if (!replay->loadFile(path, error))
+    {
+        delete replay;
+        return false;
+    }
+    replay->setSpeed(speed);
+    connect(replay, &QIODevice::readyRead, this, &SerialWorker::onReadyRead);
+    connect(replay, &SerialReplayDevice::txReplayed, this, &SerialWorker::onTxReplayed);
+    connect(replay, &SerialReplayDevice::replayFinished, this, [this]()
+            { postEvent(SerialEvent::ReplayFinished); });
+
+    m_framer.clear();
+    resetLineNumbering();
+    m_replay = replay;
+    m_port = replay;
+    m_replay->open(QIODevice::ReadWrite);
+    return true;
+}
+
+bool SerialWorker::startCapture(const QString &path, QString *error)
+{
+    return m_capture.open(path, error);
+}
+
+void SerialWorker::stopCapture()
+{
+    m_capture.close();
+}
+
+void SerialWorker::onTxReplayed(const QByteArray &data)
+{
+    // Shown line by line, like lines sent live
+    for (const QByteArray &line : data.split('\n'))
+    {
+        const QByteArray trimmed = line.trimmed();
+        if (!trimmed.isEmpty())
+            postEvent(SerialEvent::ReplayedTx, 0, QString::fromUtf8(trimmed));
+    }
+}
+
+void SerialWorker::drainRequests()
+{
+    // Cleared before draining so a request pushed meanwhile schedules another pass
+    m_requestWakePending->store(false);
+
+    SerialRequest request;
+    while (m_requests->tryPop(request))
+    {
+        switch (request.type)
+        {
+        case SerialRequest::Enqueue:
+        {
+            if (!m_port->isOpen())
+            {
+                recordFailure(LinkStatistics::classify(request.data));
+                postEvent(SerialEvent::Failed, request.id, "Not connected to serial port");
+                break;
+            }
+            PendingCommand cmd;
+            cmd.id = request.id;
+            cmd.data = std::move(request.data);
+            cmd.timeoutMs = request.timeoutMs;
+            cmd.queuedNs = request.queuedNs;
+            cmd.kind = LinkStatistics::classify(cmd.data);
+            m_sendQueue.enqueue(cmd);
+            break;
+        }
+        case SerialRequest::ClearQueue:
+            while (!m_sendQueue.isEmpty())
+            {
+                const PendingCommand cmd = m_sendQueue.dequeue();
+                recordFailure(cmd.kind);
+                postEvent(SerialEvent::Failed, cmd.id, "Command cancelled");
+            }
+            break;
+        case SerialRequest::Cancel:
+            for (int i = 0; i < m_sendQueue.size(); ++i)
+            {
+                if (m_sendQueue[i].id == request.id)
+                {
+                    const PendingCommand cmd = m_sendQueue.takeAt(i);
+                    recordFailure(cmd.kind);
+                    postEvent(SerialEvent::Failed, cmd.id, "Command cancelled");
+                    break;
+                }
+            }
+            break;
+        case SerialRequest::Configure:
+            configure(request);
+            break;
+        }
+    }
+    pumpQueue();
+}
+
+void SerialWorker::configure(const SerialRequest &request)
+{
+    m_streamingMode = request.mode;
+    m_windowSize = request.windowSize;
+    m_rxBufferSize = request.rxBufferSize;
+    if (request.lineNumbering && !m_lineNumbering)
+        m_lineNumberReset = true;
+    m_lineNumbering = request.lineNumbering;
+}
+
+void SerialWorker::customEvent(QEvent *event)
+{
+    if (event->type() == EmergencyStopEvent::EventType)
+        emergencyStop(static_cast<EmergencyStopEvent *>(event)->requestedNs);
+}
+
+void SerialWorker::emergencyStop(qint64 requestedNs)
+{
+    // Unnumbered, so Marlin's emergency parser takes it whatever the line
+    // count. The leading newline ends any line the output flush below cut
+    // short, so M112 is never appended to its tail.
+    static const QByteArray stop("\nM112\n");
+
+    if (!m_port->isOpen())
+    {
+        postEvent(SerialEvent::Error, 0, "Emergency stop not sent: not connected to serial port");
+        return;
+    }
+
+    // Bytes still in the port's output buffer would reach the firmware first
+    if (m_port == m_serial)
+        m_serial->clear(QSerialPort::Output);
+    const bool written = m_port->write(stop) == stop.size();
+    if (m_port == m_serial)
+        m_serial->flush();
+    const qint64 writtenNs = LinkStatistics::nowNs();
+
+    if (written && m_capture.isOpen())
+        m_capture.record(SerialSessionRecord::Tx, stop.constData(), stop.size());
+
+    // Nothing queued before the stop may follow it: drop the host queue, the
+    // window and requests still in the ring
+    failAll("Emergency stop");
+    SerialRequest request;
+    while (m_requests->tryPop(request))
+    {
+        if (request.type == SerialRequest::Enqueue)
+        {
+            recordFailure(LinkStatistics::classify(request.data));
+            postEvent(SerialEvent::Failed, request.id, "Emergency stop");
+        }
+        else if (request.type == SerialRequest::Configure)
+            configure(request);
+    }
+
+    if (!written)
+    {
+        QString err = "Failed to write emergency stop to serial port";
+        qCritical() << err;
+        postEvent(SerialEvent::Error, 0, err);
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.bytesWritten += quint64(stop.size());
+        m_stats.emergencyStop.record(quint64(qMax<qint64>(0, writtenNs - requestedNs) / 1000));
+    }
+
+    SerialEvent event;
+    event.type = SerialEvent::EmergencyStopSent;
+    event.latencyNs = writtenNs - requestedNs;
+    pushEvent(std::move(event));
+    postEvent(SerialEvent::QueueEmpty);
+}
+
+void SerialWorker::pushEvent(SerialEvent &&event)
+{
+    // Keep ordering: once anything overflowed, later events queue behind it
+    if (!m_eventOverflow.isEmpty() || !m_events->tryPush(std::move(event)))
+    {
+        m_eventOverflow.enqueue(std::move(event));
+        if (!m_eventRetryTimer->isActive())
+            m_eventRetryTimer->start();
+    }
+
+    if (!m_eventWakePending->exchange(true))
+        QMetaObject::invokeMethod(m_eventReceiver, "drainEvents", Qt::QueuedConnection);
+}
+
+void SerialWorker::flushEvents()
+{
+    while (!m_eventOverflow.isEmpty() && m_events->tryPush(std::move(m_eventOverflow.head())))
+        m_eventOverflow.dequeue();
+
+    if (!m_eventOverflow.isEmpty())
+        m_eventRetryTimer->start();
+
+    if (!m_eventWakePending->exchange(true))
+        QMetaObject::invokeMethod(m_eventReceiver, "drainEvents", Qt::QueuedConnection);
+}
+
+void SerialWorker::postEvent(SerialEvent::Type type, quint64 id, const QString &text)
+{
+    SerialEvent event;
+    event.type = type;
+    event.id = id;
+    event.text = text;
+    pushEvent(std::move(event));
+}
+
+bool SerialWorker::canSend(const PendingCommand &cmd) const
+{
+    switch (m_streamingMode)
+    {
+    case StreamingMode::SendAndWait:
+        return m_inFlight.isEmpty();
+    case StreamingMode::Windowed:
+        return m_inFlight.size() < m_windowSize;
+    case StreamingMode::CharacterCounting:
+        // A line longer than the whole RX buffer can still go out once the link is idle
+        return m_inFlight.isEmpty() || m_inFlightBytes + cmd.data.size() <= m_rxBufferSize;
+    }
+    return false;
+}
+
+void SerialWorker::pumpQueue()
+{
+    while (!m_sendQueue.isEmpty())
+    {
+        if (!m_port->isOpen())
+        {
+            failAll("Not connected to serial port");
+            return;
+        }
+
+        // Framed before the budget check: the N/checksum framing is what
+        // occupies the firmware's RX buffer. Nothing is consumed until it fits.
+        PendingCommand cmd;
+        const bool resetNumbering = m_lineNumbering && m_lineNumberReset;
+        if (resetNumbering)
+        {
+            // Internal (id 0); Marlin takes any N on M110 and counts on from it
+            cmd.data = numberLine(0, "M110 N0");
+            cmd.lineNumber = 0;
+        }
+        else
+        {
+            cmd = m_sendQueue.head();
+            if (m_lineNumbering)
+            {
+                const QByteArray framed = numberLine(m_nextLineNumber, cmd.data);
+                if (!framed.isEmpty())
+                {
+                    cmd.data = framed;
+                    cmd.lineNumber = m_nextLineNumber;
+                }
+            }
+        }
+        if (!canSend(cmd))
+            break;
+
+        if (resetNumbering)
+        {
+            m_nextLineNumber = 1;
+            m_lineNumberReset = false;
+        }
+        else
+        {
+            m_sendQueue.dequeue();
+            if (cmd.lineNumber >= 0)
+                ++m_nextLineNumber;
+        }
+
+        // Acks are still matched per line; only the write itself is shared
+        m_writeBuffer.append(cmd.data);
+        ++m_unwrittenCount;
+        cmd.deadline = m_clock.elapsed() + cmd.timeoutMs;
+        m_inFlightBytes += cmd.data.size();
+        m_inFlight.enqueue(cmd);
+    }
+
+    if (m_unwrittenCount > 0)
+    {
+        // Window full: nothing else can join this write, so don't wait for the loop
+        if (!m_sendQueue.isEmpty())
+            flushWrites();
+        else if (!m_writeFlushTimer->isActive())
+            m_writeFlushTimer->start();
+    }
+    publishStats();
+    armAckTimer();
+}
+
+QByteArray SerialWorker::numberLine(qint64 number, const QByteArray &line) const
+{
+    // Marlin discards everything after ';' before checking, checksum included
+    QByteArray text = line;
+    const int comment = text.indexOf(';');
+    if (comment >= 0)
+        text.truncate(comment);
+    text = text.trimmed();
+    if (text.isEmpty())
+        return QByteArray();
+
+    QByteArray framed;
+    framed.reserve(text.size() + 16);
+    framed.append('N').append(QByteArray::number(number)).append(' ').append(text);
+    quint8 checksum = 0;
+    for (char c : framed)
+        checksum ^= quint8(c);
+    framed.append('*').append(QByteArray::number(checksum)).append('\n');
+    return framed;
+}
+
+void SerialWorker::handleResend(qint64 number)
+{
+    // Marlin empties its RX buffer when it rejects a line, so how many of the
+    // lines behind it are rejected again is unknown. Those that are come with
+    // "Line Number is not Last Line Number+1" and a request for the same line,
+    // which the retransmission already covers. A checksum or missing-checksum
+    // rejection of that line is its retransmitted copy failing, and is acted on.
+    const bool stale = number == m_resendLine && m_sequenceError;
+    m_sequenceError = false;
+    if (stale)
+        return;
+
+    int first = -1;
+    for (int i = 0; i < m_inFlight.size(); ++i)
+    {
+        if (m_inFlight[i].lineNumber == number)
+        {
+            first = i;
+            break;
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_statsMutex);
+        ++m_stats.resendRequests;
+    }
+
+    if (first < 0)
+    {
+        // Already failed (timeout) or never sent; start a fresh numbering
+        // run so the lines that follow are accepted again
+        QString err = QString("Firmware requested resend of line %1, which is no longer held").arg(number);
+        qWarning() << err;
+        postEvent(SerialEvent::Error, 0, err);
+        m_lineNumberReset = true;
+        m_resendLine = -1;
+        return;
+    }
+
+    // Everything from the requested line on goes out again in order; lines
+    // still waiting in m_writeBuffer simply join the retransmission
+    m_resendLine = number;
+
+    m_writeFlushTimer->stop();
+    m_writeBuffer.clear();
+    for (int i = first; i < m_inFlight.size(); ++i)
+        m_writeBuffer.append(m_inFlight[i].data);
+    m_unwrittenCount = m_inFlight.size() - first;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.linesResent += quint64(m_unwrittenCount);
+    }
+
+    // The resent line gets a full timeout again
+    m_inFlight.head().deadline = m_clock.elapsed() + m_inFlight.head().timeoutMs;
+    flushWrites();
+    armAckTimer();
+}
+
+void SerialWorker::resetLineNumbering()
+{
+    m_lineNumberReset = true;
+    m_resendOks = 0;
+    m_resendLine = -1;
+    m_sequenceError = false;
+}
+
+void SerialWorker::flushWrites()
+{
+    m_writeFlushTimer->stop();
+    if (m_unwrittenCount == 0)
+        return;
+
+    const int lines = m_unwrittenCount;
+    const QByteArray data = m_writeBuffer;
+    m_writeBuffer.clear();
+    m_unwrittenCount = 0;
+
+    if (m_port->write(data) == -1)
+    {
+        // None of the batch reached the port; fail each of its lines
+        QList<PendingCommand> failed;
+        for (int i = 0; i < lines && !m_inFlight.isEmpty(); ++i)
+        {
+            PendingCommand cmd = m_inFlight.takeLast();
+            m_inFlightBytes -= cmd.data.size();
+            failed.prepend(cmd);
+        }
+        for (const PendingCommand &cmd : failed)
+        {
+            if (cmd.lineNumber >= 0)
+                m_lineNumberReset = true; // The firmware never saw this number
+            QString err = QString("Failed to write command to serial port: %1").arg(QString::fromUtf8(cmd.data.trimmed()));
+            qCritical() << err;
+            postEvent(SerialEvent::Error, 0, err);
+            if (cmd.id != 0)
+            {
+                recordFailure(cmd.kind);
+                postEvent(SerialEvent::Failed, cmd.id, err);
+            }
+        }
+        publishStats();
+        armAckTimer();
+        pumpQueue();
+        return;
+    }
+
+    if (m_capture.isOpen())
+        m_capture.record(SerialSessionRecord::Tx, data.constData(), data.size());
+
+    // The batch is the tail of the in-flight queue
+    const qint64 now = LinkStatistics::nowNs();
+    for (int i = m_inFlight.size() - lines; i < m_inFlight.size(); ++i)
+        m_inFlight[i].writtenNs = now;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.bytesWritten += quint64(data.size());
+    }
+
+    writeCount.fetch_add(1, std::memory_order_relaxed);
+    linesWritten.fetch_add(quint64(lines), std::memory_order_relaxed);
+}
+
+LinkStatistics SerialWorker::statistics() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_stats;
+}
+
+void SerialWorker::resetStatistics()
+{
+    QMutexLocker locker(&m_statsMutex);
+    m_stats.reset();
+}
+
+void SerialWorker::recordFailure(LinkStatistics::Kind kind)
+{
+    QMutexLocker locker(&m_statsMutex);
+    m_stats.recordFailure(kind);
+}
+
+void SerialWorker::armAckTimer()
+{
+    if (m_inFlight.isEmpty())
+    {
+        m_ackTimer->stop();
+        return;
+    }
+    m_ackTimer->start(int(qMax<qint64>(0, m_inFlight.head().deadline - m_clock.elapsed())));
+}
+
+void SerialWorker::publishStats()
+{
+    inFlightCount.store(m_inFlight.size(), std::memory_order_relaxed);
+    inFlightBytes.store(m_inFlightBytes, std::memory_order_relaxed);
+}
+
+void SerialWorker::onReadyRead()
+{
+    quint64 bytes = 0;
+    int lines = 0;
+    auto onLine = [this, &bytes](std::string_view line)
+    {
+        bytes += line.size() + 1;
+        processLine(line);
+    };
+
+    if (m_capture.isOpen())
+    {
+        // Taken in one piece so the capture holds the bytes exactly as they arrived
+        const QByteArray raw = m_port->readAll();
+        m_capture.record(SerialSessionRecord::Rx, raw.constData(), raw.size());
+        std::string_view line;
+        for (int offset = 0; offset < raw.size();)
+        {
+            offset += m_framer.append(raw.constData() + offset, raw.size() - offset);
+            while (m_framer.nextLine(line))
+            {
+                onLine(line);
+                ++lines;
+            }
+        }
+    }
+    else
+    {
+        lines = m_framer.readLines(m_port, onLine);
+    }
+
+    QMutexLocker locker(&m_statsMutex);
+    m_stats.bytesReceived += bytes;
+    m_stats.linesReceived += quint64(lines);
+}
+
+void SerialWorker::processLine(std::string_view view)
+{
+    // Non-owning wrapper; bytes are only copied when appended to a response
+    const QByteArray line = QByteArray::fromRawData(view.data(), int(view.size()));
+
+    postEvent(SerialEvent::LineReceived, 0, QString::fromUtf8(line));
+
+    if (line.startsWith("ok"))
+    {
+        if (m_resendOks > 0)
+        {
+            // Follows a resend request and answers the rejected copy
+            --m_resendOks;
+            return;
+        }
+        if (m_inFlight.isEmpty())
+        {
+            qWarning() << "Unexpected acknowledgement with no command in flight";
+            return;
+        }
+        PendingCommand &head = m_inFlight.head();
+        completeHead(!head.errorSeen, QString::fromUtf8(head.response));
+        return;
+    }
+
+    // Marlin rejected a numbered line: "Resend: <n>" and an "ok" for the rejected copy
+    if (line.startsWith("Resend:") || line.startsWith("rs "))
+    {
+        bool ok = false;
+        const qint64 number = line.mid(line.startsWith("rs ") ? 3 : 7).trimmed().toLongLong(&ok);
+        ++m_resendOks;
+        if (ok)
+            handleResend(number);
+        return;
+    }
+
+    // "Error:checksum mismatch, Last Line: 12" and friends precede a resend
+    // request; they are about the transfer, not the head command
+    if (line.startsWith("Error:") && line.contains("Last Line:"))
+    {
+        m_sequenceError = line.contains("Line Number is not Last Line Number+1");
+        return;
+    }
+
+    // GRBL reports "error:<code>" instead of "ok"; Marlin prints "Error:..." and still sends "ok"
+    if (line.startsWith("error:"))
+    {
+        if (!m_inFlight.isEmpty())
+            completeHead(false, QString::fromUtf8(line));
+        return;
+    }
+
+    // Position reports arrive as M114 replies and as unsolicited auto-reports
+    if (view.size() > 2 && view[0] == 'X' && view[1] == ':')
+    {
+        SerialEvent event;
+        if (parsePositionReport(view, event.position))
+        {
+            event.type = SerialEvent::Position;
+            event.position.timestampNs = LinkStatistics::nowNs();
+            pushEvent(std::move(event));
+        }
+    }
+
+    if (m_inFlight.isEmpty())
+        return; // Unsolicited output (echo:, auto-reports)
+
+    PendingCommand &head = m_inFlight.head();
+    if (line.startsWith("busy:") || line.startsWith("echo:busy:"))
+    {
+        // Firmware keepalive during long moves or homing (Marlin prefixes it with "echo:")
+        head.deadline = m_clock.elapsed() + head.timeoutMs;
+        armAckTimer();
+        return;
+    }
+
+    if (line.startsWith("Error:"))
+        head.errorSeen = true;
+
+    if (!head.response.isEmpty())
+        head.response.append('\n');
+    head.response.append(line.constData(), line.size());
+}
+
+void SerialWorker::completeHead(bool success, const QString &error)
+{
+    PendingCommand cmd = m_inFlight.dequeue();
+    m_inFlightBytes -= cmd.data.size();
+    // A stray "ok" (or a timeout) can reach a line still waiting in
+    // m_writeBuffer; the unwritten batch must stay the tail of m_inFlight
+    if (m_unwrittenCount > m_inFlight.size())
+        --m_unwrittenCount;
+    // Lines never written count as failed but stay out of the latency histograms
+    if (cmd.id != 0 && (cmd.writtenNs != 0 || !success))
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.recordAck(cmd.kind, cmd.queuedNs, cmd.writtenNs, LinkStatistics::nowNs(), success);
+    }
+
+    // With several lines outstanding the firmware acks them one by one, so the
+    // next command's timeout only starts once it reaches the head of the window
+    if (!m_inFlight.isEmpty())
+        m_inFlight.head().deadline = m_clock.elapsed() + m_inFlight.head().timeoutMs;
+
+    // id 0 is an internal M110 nobody waits for
+    if (cmd.id != 0)
+    {
+        if (success)
+            postEvent(SerialEvent::Completed, cmd.id, QString::fromUtf8(cmd.response));
+        else
+            postEvent(SerialEvent::Failed, cmd.id, error.isEmpty() ? QString::fromUtf8(cmd.response) : error);
+    }
+
+    pumpQueue();
+    if (m_sendQueue.isEmpty() && m_inFlight.isEmpty())
+        postEvent(SerialEvent::QueueEmpty);
+}
+
+void SerialWorker::onAckTimeout()
+{
+    if (m_inFlight.isEmpty())
+        return;
+
+    QString err = QString("Timeout waiting for response to command: %1").arg(QString::fromUtf8(m_inFlight.head().data.trimmed()));
+    qWarning() << err;
+    postEvent(SerialEvent::Error, 0, err);
+    completeHead(false, err);
+}
+
+void SerialWorker::failAll(const QString &reason)
+{
+    m_ackTimer->stop();
+    QQueue<PendingCommand> dropped;
+    dropped.swap(m_inFlight);
+    dropped.append(m_sendQueue);
+    m_sendQueue.clear();
+    m_inFlightBytes = 0;
+    m_writeBuffer.clear();
+    m_unwrittenCount = 0;
+    m_writeFlushTimer->stop();
+    m_framer.clear();
+    resetLineNumbering();
+    publishStats();
+
+    for (const PendingCommand &cmd : dropped)
+    {
+        if (cmd.id != 0)
+        {
+            recordFailure(cmd.kind);
+            postEvent(SerialEvent::Failed, cmd.id, reason);
+        }
+    }
+}
+
+void SerialWorker::onErrorOccurred(QSerialPort::SerialPortError error)
+{
+    if (error == QSerialPort::NoError)
+        return;
+
+    QString err = QString("Serial port error: %1").arg(m_serial->errorString());
+    qCritical() << err;
+    postEvent(SerialEvent::PortError, 0, err);
+
+    // The device went away (unplugged, reset); nothing more can be written
+    if (error == QSerialPort::ResourceError && m_serial->isOpen())
+    {
+        closePort(err);
+        postEvent(SerialEvent::Disconnected, 0, err);
+    }
+}
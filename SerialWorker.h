@@ -0,0 +1,205 @@
+// SerialWorker.h
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QEvent>
+#include <QSerialPort>
+#include <QTimer>
+#include <QQueue>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <atomic>
+#include "TinybeeController.h"
+#include "LineFramer.h"
+#include "LinkStatistics.h"
+#include "SerialSession.h"
+#include "SpscQueue.h"
+
+// Request from TinyBeeController (GUI thread) to the serial thread
+struct SerialRequest
+{
+    enum Type
+    {
+        Enqueue,
+        ClearQueue,
+        Cancel, // The command with id, if it is still in the host queue
+        Configure
+    };
+
+    Type type = Enqueue;
+    quint64 id = 0;
+    QByteArray data; // Serialized line including the trailing '\n'
+    int timeoutMs = 2000;
+    qint64 queuedNs = 0; // LinkStatistics::nowNs() when the caller queued it
+
+    // Configure
+    StreamingMode mode = StreamingMode::SendAndWait;
+    int windowSize = 4;
+    int rxBufferSize = 127;
+    bool lineNumbering = false;
+};
+
+// Out-of-band stop request. Posted straight to the worker with
+// Qt::HighEventPriority, so it overtakes the request ring and anything else
+// already waiting in the I/O thread's event queue.
+class EmergencyStopEvent : public QEvent
+{
+public:
+    static constexpr QEvent::Type EventType = QEvent::Type(QEvent::User + 1);
+    explicit EmergencyStopEvent(qint64 requestedNs) : QEvent(EventType), requestedNs(requestedNs) {}
+
+    qint64 requestedNs; // LinkStatistics::nowNs() when the stop was requested
+};
+
+// Event from the serial thread back to TinyBeeController
+struct SerialEvent
+{
+    enum Type
+    {
+        Completed,
+        Failed,
+        LineReceived,
+        Position,
+        Error,     // Command-level problem (write failure, timeout)
+        PortError, // Reported by QSerialPort
+        Disconnected,
+        QueueEmpty,
+        ReplayedTx,    // Line sent in a session being replayed
+        ReplayFinished,
+        EmergencyStopSent
+    };
+
+    Type type = LineReceived;
+    quint64 id = 0;
+    QString text; // Response, error, received or replayed line
+    MotorPosition position;
+    qint64 latencyNs = 0; // EmergencyStopSent: request to bytes handed to the driver
+};
+
+// Owns the serial port and the command pipeline (send queue, in-flight window,
+// ack matching, timeouts). Lives in TinyBeeController's I/O thread so a busy GUI
+// thread never delays reads or leaves the firmware planner starved.
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+public:
+    SerialWorker(SpscQueue<SerialRequest> *requests, SpscQueue<SerialEvent> *events,
+                 std::atomic<bool> *requestWakePending, std::atomic<bool> *eventWakePending,
+                 QObject *eventReceiver);
+
+    // Called through blocking queued invocations from the GUI thread
+    bool openPort(const QString &portName, qint32 baudRate, QString *error);
+    void closePort(const QString &reason);
+    // Plays a recorded session in place of the port (speed 0 = unpaced)
+    bool openReplay(const QString &path, double speed, QString *error);
+    // Records raw traffic of whatever is open, port or replay
+    bool startCapture(const QString &path, QString *error);
+    void stopCapture();
+
+    // Queue statistics published for the GUI thread
+    std::atomic<int> inFlightCount{0};
+    std::atomic<int> inFlightBytes{0};
+    std::atomic<quint64> writeCount{0};   // QSerialPort::write calls
+    std::atomic<quint64> linesWritten{0}; // Lines carried by those writes
+
+    // Thread-safe copy of the latency histograms and byte counters
+    LinkStatistics statistics() const;
+    void resetStatistics();
+
+public slots:
+    void drainRequests();
+
+protected:
+    void customEvent(QEvent *event) override;
+
+private slots:
+    void onReadyRead();
+    void onErrorOccurred(QSerialPort::SerialPortError error);
+    void onAckTimeout();
+    void flushWrites();
+
+private:
+    struct PendingCommand
+    {
+        quint64 id = 0;
+        QByteArray data;
+        QByteArray response; // Lines received before the acknowledgement
+        int timeoutMs = 2000;
+        qint64 deadline = 0; // m_clock time by which the ack must arrive
+        bool errorSeen = false;
+        LinkStatistics::Kind kind = LinkStatistics::Other;
+        qint64 queuedNs = 0;
+        qint64 writtenNs = 0; // 0 until handed to the port
+        qint64 lineNumber = -1; // N word when sent with line number and checksum
+    };
+
+    SpscQueue<SerialRequest> *m_requests;
+    SpscQueue<SerialEvent> *m_events;
+    std::atomic<bool> *m_requestWakePending;
+    std::atomic<bool> *m_eventWakePending;
+    QObject *m_eventReceiver;
+
+    QSerialPort *m_serial;
+    SerialReplayDevice *m_replay = nullptr;
+    QIODevice *m_port; // m_serial or m_replay
+    SerialSessionWriter m_capture;
+    QTimer *m_ackTimer;
+    QTimer *m_eventRetryTimer;
+    QTimer *m_writeFlushTimer;
+    LineFramer m_framer;
+    QElapsedTimer m_clock;
+
+    QQueue<PendingCommand> m_sendQueue; // Not yet written
+    QQueue<PendingCommand> m_inFlight;  // Written, waiting for "ok"
+    QQueue<SerialEvent> m_eventOverflow; // Events that did not fit while the GUI lagged
+    int m_inFlightBytes = 0;
+
+    // Lines moved to m_inFlight but not yet handed to the port. They go out
+    // together in one write at the end of the event-loop turn, or right away
+    // once the window is full and nothing more could join them.
+    QByteArray m_writeBuffer;
+    int m_unwrittenCount = 0; // Tail of m_inFlight still in m_writeBuffer
+
+    // Written on this thread; the mutex is only contended while a snapshot is taken
+    LinkStatistics m_stats;
+    mutable QMutex m_statsMutex;
+
+    StreamingMode m_streamingMode = StreamingMode::SendAndWait;
+    int m_windowSize = 4;
+    int m_rxBufferSize = 127;
+
+    // Marlin line numbering. Lines stay in m_inFlight until their "ok", and
+    // the firmware only asks for lines it has not accepted, so the in-flight
+    // window is all that must be retained for resends.
+    bool m_lineNumbering = false;
+    bool m_lineNumberReset = true; // M110 must precede the next numbered line
+    qint64 m_nextLineNumber = 0;
+    int m_resendOks = 0;           // "ok"s answering rejected lines, not the head
+    qint64 m_resendLine = -1;      // Line of the last resend performed
+    // The Error: before the resend request said the line was out of sequence
+    // (not corrupt): a line already on the wire behind the rejected one
+    bool m_sequenceError = false;
+
+    void onTxReplayed(const QByteArray &data);
+    void emergencyStop(qint64 requestedNs);
+    void configure(const SerialRequest &request);
+
+    void pushEvent(SerialEvent &&event);
+    void flushEvents();
+    void postEvent(SerialEvent::Type type, quint64 id = 0, const QString &text = QString());
+
+    void pumpQueue();
+    bool canSend(const PendingCommand &cmd) const;
+    QByteArray numberLine(qint64 number, const QByteArray &line) const;
+    void handleResend(qint64 number);
+    void resetLineNumbering();
+    void processLine(std::string_view line);
+    void completeHead(bool success, const QString &error = QString());
+    void recordFailure(LinkStatistics::Kind kind);
+    void armAckTimer();
+    void failAll(const QString &reason);
+    void publishStats();
+};
+
+#endif // SERIALWORKER_H
@@ -0,0 +1,79 @@
+// SpscQueue.h
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free single-producer/single-consumer ring. tryPush() must only
+// be called from one thread and tryPop() from one other thread; neither ever
+// blocks. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size *= 2;
+        m_slots.reset(new T[size]);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(T &&value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask)
+                return false; // Full
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return false; // Empty
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_slots[head & m_mask] = T(); // Release payload memory now, not when the slot is reused
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with the other side
+    size_t size() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t CacheLine = 64;
+
+    std::unique_ptr<T[]> m_slots;
+    size_t m_mask = 0;
+
+    // Producer and consumer indices live on separate cache lines, each next to
+    // the owning side's cached copy of the other index
+    alignas(CacheLine) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+    alignas(CacheLine) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail = 0;
+};
+
+#endif // SPSCQUEUE_H
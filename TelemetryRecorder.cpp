@@ -0,0 +1,484 @@
+// TelemetryRecorder.cpp
+#include "TelemetryRecorder.h"
+#include "LinkStatistics.h"
+#include "SpscQueue.h"
+#include "TinybeeController.h"
+#include <QDateTime>
+#include <QDebug>
+
+namespace
+{
+constexpr qint64 SegmentBytes = 16 * 1024 * 1024; // File growth step
+
+int columnCount(int stream)
+{
+    return stream == TelemetryRecorder::Positions ? int(std::size(TelemetryFormat::PositionWidths))
+                                                  : int(std::size(TelemetryFormat::CommandWidths));
+}
+
+int columnWidth(int stream, int column)
+{
+    return stream == TelemetryRecorder::Positions ? TelemetryFormat::PositionWidths[column]
+                                                  : TelemetryFormat::CommandWidths[column];
+}
+
+qint64 paddedTo8(qint64 bytes)
+{
+    return (bytes + 7) & ~qint64(7);
+}
+
+// Bytes a chunk of the given stream occupies in the file
+qint64 chunkFileSize(int stream, int rows)
+{
+    qint64 size = TelemetryFormat::ChunkHeaderSize;
+    for (int c = 0; c < columnCount(stream); ++c)
+        size += paddedTo8(qint64(columnWidth(stream, c)) * rows);
+    return size;
+}
+
+template <typename T>
+void store(uchar *base, qint64 offset, const T &value)
+{
+    std::memcpy(base + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T load(const uchar *base, qint64 offset)
+{
+    T value;
+    std::memcpy(&value, base + offset, sizeof(T));
+    return value;
+}
+} // namespace
+
+// One block of rows, stored column by column with room for ChunkRows rows each
+struct TelemetryChunk
+{
+    int stream = TelemetryRecorder::Positions;
+    int rows = 0;
+    qint64 firstNs = 0;
+    qint64 lastNs = 0;
+    std::vector<uchar> data;
+    qint64 columnOffset[TelemetryFormat::MaxColumns] = {};
+
+    void reset(int newStream)
+    {
+        stream = newStream;
+        rows = 0;
+        qint64 offset = 0;
+        for (int c = 0; c < columnCount(stream); ++c)
+        {
+            columnOffset[c] = offset;
+            offset += qint64(columnWidth(stream, c)) * TelemetryRecorder::ChunkRows;
+        }
+        data.resize(size_t(offset));
+    }
+
+    template <typename T>
+    void set(int column, const T &value)
+    {
+        store(data.data(), columnOffset[column] + qint64(rows) * qint64(sizeof(T)), value);
+    }
+};
+
+// Lives on the recorder's writer thread; owns the file and its mapping
+class TelemetryWriter : public QObject
+{
+public:
+    TelemetryWriter(SpscQueue<TelemetryChunk *> *filled, SpscQueue<TelemetryChunk *> *free,
+                    std::atomic<bool> *wakePending)
+        : m_filled(filled), m_free(free), m_wakePending(wakePending)
+    {
+    }
+
+    std::atomic<qint64> bytesWritten{0};
+
+    bool open(const QString &path, QString *error)
+    {
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        {
+            if (error)
+                *error = m_file.errorString();
+            return false;
+        }
+
+        uchar header[TelemetryFormat::FileHeaderSize] = {};
+        std::memcpy(header, TelemetryFormat::FileMagic, sizeof(TelemetryFormat::FileMagic));
+        store(header, 8, TelemetryFormat::Version);
+        store(header, 12, quint32(TelemetryRecorder::ChunkRows));
+        store(header, 16, QDateTime::currentMSecsSinceEpoch());
+        store(header, 24, LinkStatistics::nowNs());
+        // Offset 32: end of valid data, filled in by finish()
+        if (m_file.write(reinterpret_cast<const char *>(header), sizeof(header)) != qint64(sizeof(header)))
+        {
+            if (error)
+                *error = m_file.errorString();
+            m_file.close();
+            return false;
+        }
+
+        m_writePos = TelemetryFormat::FileHeaderSize;
+        m_failed = false;
+        bytesWritten.store(m_writePos);
+        return true;
+    }
+
+    void drain()
+    {
+        m_wakePending->store(false);
+
+        TelemetryChunk *chunk;
+        while (m_filled->tryPop(chunk))
+        {
+            write(*chunk);
+            m_free->tryPush(std::move(chunk)); // Ring holds the whole pool, never full
+        }
+    }
+
+    void finish()
+    {
+        drain();
+        if (!m_file.isOpen())
+            return;
+
+        unmap();
+        m_file.resize(m_writePos);
+        m_file.seek(32);
+        const qint64 end = m_writePos;
+        m_file.write(reinterpret_cast<const char *>(&end), sizeof(end));
+        m_file.close();
+    }
+
+private:
+    SpscQueue<TelemetryChunk *> *m_filled;
+    SpscQueue<TelemetryChunk *> *m_free;
+    std::atomic<bool> *m_wakePending;
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    qint64 m_mapOffset = 0;
+    qint64 m_mapSize = 0;
+    qint64 m_writePos = 0;
+    bool m_failed = false;
+
+    void unmap()
+    {
+        if (m_map)
+            m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+
+    // Makes [m_writePos, m_writePos + bytes) addressable through m_map
+    bool reserve(qint64 bytes)
+    {
+        if (m_map && m_writePos + bytes <= m_mapOffset + m_mapSize)
+            return true;
+
+        unmap();
+        const qint64 size = qMax(bytes, SegmentBytes);
+        if (!m_file.resize(m_writePos + size))
+            return false;
+        m_map = m_file.map(m_writePos, size);
+        if (!m_map)
+            return false;
+        m_mapOffset = m_writePos;
+        m_mapSize = size;
+        return true;
+    }
+
+    void write(const TelemetryChunk &chunk)
+    {
+        if (m_failed || chunk.rows == 0 || !m_file.isOpen())
+            return;
+
+        const qint64 size = chunkFileSize(chunk.stream, chunk.rows);
+        if (!reserve(size))
+        {
+            // Disk full or mapping failed; keep the data written so far
+            qWarning() << "Telemetry recording stopped:" << m_file.errorString();
+            m_failed = true;
+            return;
+        }
+
+        uchar *out = m_map + (m_writePos - m_mapOffset);
+        std::memset(out, 0, size_t(size));
+        store(out, 0, TelemetryFormat::ChunkMagic);
+        store(out, 4, quint32(chunk.stream));
+        store(out, 8, quint32(chunk.rows));
+        store(out, 16, chunk.firstNs);
+        store(out, 24, chunk.lastNs);
+
+        qint64 offset = TelemetryFormat::ChunkHeaderSize;
+        for (int c = 0; c < columnCount(chunk.stream); ++c)
+        {
+            const qint64 bytes = qint64(columnWidth(chunk.stream, c)) * chunk.rows;
+            std::memcpy(out + offset, chunk.data.data() + chunk.columnOffset[c], size_t(bytes));
+            offset += paddedTo8(bytes);
+        }
+
+        m_writePos += size;
+        bytesWritten.store(m_writePos, std::memory_order_relaxed);
+    }
+};
+
+TelemetryRecorder::TelemetryRecorder(QObject *parent)
+    : QObject(parent),
+      m_filled(new SpscQueue<TelemetryChunk *>(PoolChunks * StreamCount)),
+      m_free(new SpscQueue<TelemetryChunk *>(PoolChunks * StreamCount))
+{
+    for (int i = 0; i < PoolChunks * StreamCount; ++i)
+    {
+        m_pool.emplace_back(new TelemetryChunk);
+        TelemetryChunk *chunk = m_pool.back().get();
+        m_free->tryPush(std::move(chunk));
+    }
+
+    // Partial chunks are written once a second, so a crash loses little
+    m_flushTimer.setInterval(1000);
+    connect(&m_flushTimer, &QTimer::timeout, this, &TelemetryRecorder::flushPartial);
+
+    m_writer = new TelemetryWriter(m_filled.get(), m_free.get(), &m_wakePending);
+    m_writer->moveToThread(&m_writerThread);
+    connect(&m_writerThread, &QThread::finished, m_writer, &QObject::deleteLater);
+    m_writerThread.setObjectName("Telemetry writer");
+    m_writerThread.start();
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    stop();
+    m_writerThread.quit();
+    m_writerThread.wait();
+}
+
+bool TelemetryRecorder::start(const QString &path, QString *error)
+{
+    stop();
+
+    bool opened = false;
+    QMetaObject::invokeMethod(m_writer, [&]()
+                              { opened = m_writer->open(path, error); }, Qt::BlockingQueuedConnection);
+    if (!opened)
+    {
+        qWarning() << "Failed to start telemetry recording to" << path;
+        return false;
+    }
+
+    m_recording = true;
+    m_rowsRecorded = 0;
+    m_rowsDropped = 0;
+    m_flushTimer.start();
+    return true;
+}
+
+void TelemetryRecorder::stop()
+{
+    if (!m_recording)
+        return;
+
+    flushPartial();
+    m_flushTimer.stop();
+    m_recording = false;
+    QMetaObject::invokeMethod(m_writer, [this]()
+                              { m_writer->finish(); }, Qt::BlockingQueuedConnection);
+    // Empty chunks left in m_current are reused by the next recording
+}
+
+qint64 TelemetryRecorder::bytesWritten() const
+{
+    return m_writer->bytesWritten.load(std::memory_order_relaxed);
+}
+
+void TelemetryRecorder::attach(TinyBeeController *controller)
+{
+    detach();
+    m_controller = controller;
+    connect(controller, &TinyBeeController::positionUpdated, this, &TelemetryRecorder::recordPosition);
+    connect(controller, &TinyBeeController::commandQueued, this, [this](quint64 id, const QByteArray &line)
+            { recordCommand(LinkStatistics::nowNs(), id, Queued, line); });
+    connect(controller, &TinyBeeController::commandCompleted, this, [this](quint64 id, const QString &)
+            { recordCommand(LinkStatistics::nowNs(), id, Completed, QByteArray()); });
+    connect(controller, &TinyBeeController::commandFailed, this, [this](quint64 id, const QString &)
+            { recordCommand(LinkStatistics::nowNs(), id, Failed, QByteArray()); });
+}
+
+void TelemetryRecorder::detach()
+{
+    if (m_controller)
+        disconnect(m_controller, nullptr, this, nullptr);
+    m_controller = nullptr;
+}
+
+TelemetryChunk *TelemetryRecorder::chunkFor(Stream stream)
+{
+    TelemetryChunk *&chunk = m_current[stream];
+    if (chunk && chunk->rows == ChunkRows)
+        submit(stream);
+    if (!chunk)
+    {
+        if (!m_free->tryPop(chunk))
+        {
+            chunk = nullptr;
+            return nullptr; // Writer behind and the pool is exhausted
+        }
+        chunk->reset(stream);
+    }
+    return chunk;
+}
+
+void TelemetryRecorder::submit(Stream stream)
+{
+    TelemetryChunk *chunk = m_current[stream];
+    if (!chunk || chunk->rows == 0)
+        return;
+
+    m_current[stream] = nullptr;
+    m_filled->tryPush(std::move(chunk)); // Ring holds the whole pool, never full
+    if (!m_wakePending.exchange(true))
+        QMetaObject::invokeMethod(m_writer, [this]()
+                                  { m_writer->drain(); }, Qt::QueuedConnection);
+}
+
+void TelemetryRecorder::flushPartial()
+{
+    submit(Positions);
+    submit(Commands);
+}
+
+void TelemetryRecorder::recordPosition(const MotorPosition &pos)
+{
+    if (!m_recording)
+        return;
+
+    TelemetryChunk *chunk = chunkFor(Positions);
+    if (!chunk)
+    {
+        ++m_rowsDropped;
+        return;
+    }
+
+    const qint64 t = pos.timestampNs ? pos.timestampNs : LinkStatistics::nowNs();
+    chunk->set(0, t);
+    chunk->set(1, pos.x);
+    chunk->set(2, pos.y);
+    chunk->set(3, pos.z);
+    chunk->set(4, pos.hasCounts ? pos.countX : qint64(0));
+    chunk->set(5, pos.hasCounts ? pos.countY : qint64(0));
+    chunk->set(6, pos.hasCounts ? pos.countZ : qint64(0));
+    if (chunk->rows == 0)
+        chunk->firstNs = t;
+    chunk->lastNs = t;
+    ++chunk->rows;
+    ++m_rowsRecorded;
+}
+
+void TelemetryRecorder::recordCommand(qint64 timestampNs, quint64 id, CommandEvent event, const QByteArray &line)
+{
+    if (!m_recording)
+        return;
+
+    TelemetryChunk *chunk = chunkFor(Commands);
+    if (!chunk)
+    {
+        ++m_rowsDropped;
+        return;
+    }
+
+    // Command word only ("G1", "M114"), zero padded to four bytes
+    char code[4] = {0, 0, 0, 0};
+    for (int i = 0; i < line.size() && i < 4 && line[i] != ' ' && line[i] != '\n'; ++i)
+        code[i] = line[i];
+
+    chunk->set(0, timestampNs);
+    chunk->set(1, id);
+    chunk->set(2, code);
+    chunk->set(3, quint8(line.isEmpty() ? LinkStatistics::Other : LinkStatistics::classify(line)));
+    chunk->set(4, quint8(event));
+    if (chunk->rows == 0)
+        chunk->firstNs = timestampNs;
+    chunk->lastNs = timestampNs;
+    ++chunk->rows;
+    ++m_rowsRecorded;
+}
+
+bool TelemetryReader::open(const QString &path, QString *error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    m_data = size >= TelemetryFormat::FileHeaderSize ? m_file.map(0, size) : nullptr;
+    if (!m_data || std::memcmp(m_data, TelemetryFormat::FileMagic, sizeof(TelemetryFormat::FileMagic)) != 0 ||
+        load<quint32>(m_data, 8) != TelemetryFormat::Version)
+    {
+        if (error)
+            *error = "Not a telemetry file";
+        close();
+        return false;
+    }
+
+    m_startWallMs = load<qint64>(m_data, 16);
+    m_startNs = load<qint64>(m_data, 24);
+    // An unfinished recording has no end marker; chunks are then read up to
+    // the first one that is incomplete
+    const qint64 end = load<qint64>(m_data, 32);
+    m_end = end > 0 && end <= size ? end : size;
+    m_pos = TelemetryFormat::FileHeaderSize;
+    return true;
+}
+
+void TelemetryReader::close()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar *>(m_data));
+    m_data = nullptr;
+    m_file.close();
+    m_end = 0;
+    m_pos = 0;
+}
+
+bool TelemetryReader::next(ChunkView &chunk)
+{
+    if (!m_data || m_pos + TelemetryFormat::ChunkHeaderSize > m_end)
+        return false;
+
+    const uchar *header = m_data + m_pos;
+    const quint32 stream = load<quint32>(header, 4);
+    const quint32 rows = load<quint32>(header, 8);
+    if (load<quint32>(header, 0) != TelemetryFormat::ChunkMagic || stream >= TelemetryRecorder::StreamCount ||
+        rows == 0 || rows > quint32(TelemetryRecorder::ChunkRows))
+        return false;
+
+    const qint64 size = chunkFileSize(int(stream), int(rows));
+    if (m_pos + size > m_end)
+        return false;
+
+    chunk.stream = TelemetryRecorder::Stream(stream);
+    chunk.rows = int(rows);
+    chunk.firstNs = load<qint64>(header, 16);
+    chunk.lastNs = load<qint64>(header, 24);
+    qint64 offset = TelemetryFormat::ChunkHeaderSize;
+    for (int c = 0; c < TelemetryFormat::MaxColumns; ++c)
+    {
+        if (c < columnCount(int(stream)))
+        {
+            chunk.columns[c] = header + offset;
+            offset += paddedTo8(qint64(columnWidth(int(stream), c)) * rows);
+        }
+        else
+        {
+            chunk.columns[c] = nullptr;
+        }
+    }
+
+    m_pos += size;
+    return true;
+}
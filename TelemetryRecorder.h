@@ -0,0 +1,154 @@
+// TelemetryRecorder.h
+#ifndef TELEMETRYRECORDER_H
+#define TELEMETRYRECORDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+class TinyBeeController;
+struct MotorPosition;
+struct TelemetryChunk;
+class TelemetryWriter;
+template <typename T>
+class SpscQueue;
+
+namespace TelemetryFormat
+{
+constexpr char FileMagic[8] = {'T', 'B', 'T', 'E', 'L', 'E', 'M', '1'};
+constexpr quint32 Version = 1;
+constexpr int FileHeaderSize = 64;
+constexpr quint32 ChunkMagic = 0x4B4E4843; // "CHNK"
+constexpr int ChunkHeaderSize = 32;
+constexpr int MaxColumns = 7;
+
+// Column widths in bytes per stream, in file order
+constexpr int PositionWidths[] = {8, 8, 8, 8, 8, 8, 8};
+constexpr int CommandWidths[] = {8, 8, 4, 1, 1};
+} // namespace TelemetryFormat
+
+// Records position samples and command events of a session into a binary,
+// columnar file for offline analysis.
+//
+// Rows are collected in fixed-size chunks, one array per column, on the
+// thread that owns the recorder. Full chunks go through a lock-free ring to a
+// writer thread that copies them into a memory-mapped file grown in large
+// segments. Chunks come from a fixed pool: when the writer falls behind, rows
+// are dropped and counted instead of blocking or growing memory.
+//
+// File layout (little endian; see TelemetryFormat for the constants):
+//   header   64 bytes: "TBTELEM1", version, rows per chunk, wall clock and
+//            monotonic clock at start, end of valid data
+//   chunk    32-byte header (magic, stream, row count, first/last t_ns),
+//            then each column as rows x width bytes, padded to 8 bytes
+//   Positions columns: t_ns i64, x f64, y f64, z f64, count_x i64, count_y i64, count_z i64
+//   Commands columns:  t_ns i64, id u64, code char[4] ("G1", "M114"), kind u8, event u8
+class TelemetryRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    enum Stream
+    {
+        Positions,
+        Commands,
+        StreamCount
+    };
+
+    enum CommandEvent
+    {
+        Queued,
+        Completed,
+        Failed
+    };
+
+    explicit TelemetryRecorder(QObject *parent = nullptr);
+    ~TelemetryRecorder();
+
+    bool start(const QString &path, QString *error = nullptr);
+    void stop(); // Writes pending rows and closes the file
+    bool isRecording() const { return m_recording; }
+
+    // Records positionUpdated() and the command lifecycle of controller
+    void attach(TinyBeeController *controller);
+    void detach();
+
+    void recordPosition(const MotorPosition &pos);
+    void recordCommand(qint64 timestampNs, quint64 id, CommandEvent event, const QByteArray &line);
+
+    quint64 rowsRecorded() const { return m_rowsRecorded; }
+    quint64 rowsDropped() const { return m_rowsDropped; }
+    qint64 bytesWritten() const;
+
+    static constexpr int ChunkRows = 4096;
+    static constexpr int PoolChunks = 8; // Per stream
+
+private slots:
+    void flushPartial();
+
+private:
+    QThread m_writerThread;
+    TelemetryWriter *m_writer = nullptr;
+    std::unique_ptr<SpscQueue<TelemetryChunk *>> m_filled; // Recorder -> writer
+    std::unique_ptr<SpscQueue<TelemetryChunk *>> m_free;   // Writer -> recorder
+    std::vector<std::unique_ptr<TelemetryChunk>> m_pool;
+    std::atomic<bool> m_wakePending{false};
+
+    TelemetryChunk *m_current[StreamCount] = {nullptr, nullptr};
+    QPointer<TinyBeeController> m_controller;
+    QTimer m_flushTimer;
+    bool m_recording = false;
+    quint64 m_rowsRecorded = 0;
+    quint64 m_rowsDropped = 0;
+
+    TelemetryChunk *chunkFor(Stream stream);
+    void submit(Stream stream);
+};
+
+// Reads a file written by TelemetryRecorder, chunk by chunk, straight from a
+// memory map. Files from an interrupted session are read up to the last
+// complete chunk.
+class TelemetryReader
+{
+public:
+    struct ChunkView
+    {
+        TelemetryRecorder::Stream stream = TelemetryRecorder::Positions;
+        int rows = 0;
+        qint64 firstNs = 0;
+        qint64 lastNs = 0;
+        const uchar *columns[TelemetryFormat::MaxColumns] = {}; // rows values each
+
+        template <typename T>
+        T value(int column, int row) const
+        {
+            T v;
+            std::memcpy(&v, columns[column] + size_t(row) * sizeof(T), sizeof(T));
+            return v;
+        }
+    };
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    qint64 startWallMs() const { return m_startWallMs; } // Milliseconds since epoch
+    qint64 startNs() const { return m_startNs; }         // Same instant on LinkStatistics::nowNs()
+
+    bool next(ChunkView &chunk);
+    void rewind() { m_pos = TelemetryFormat::FileHeaderSize; }
+
+private:
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_end = 0;
+    qint64 m_pos = 0;
+    qint64 m_startWallMs = 0;
+    qint64 m_startNs = 0;
+};
+
+#endif // TELEMETRYRECORDER_H
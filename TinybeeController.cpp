@@ -1,201 +1,463 @@
 // TinyBeeController.cpp
 #include "TinybeeController.h"
-#include <QElapsedTimer>
+#include "PositionParser.h"
+#include "SerialWorker.h"
+#include "SpscQueue.h"
+#include <QCoreApplication>
+#include <QEventLoop>
 #include <QDebug>
-#include <QRegularExpression>
 
 TinyBeeController::TinyBeeController(QObject *parent)
-    : QObject(parent)
+    : TinyBeeController(SharedIoThread{}, parent)
 {
-    connect(&m_serial, &QSerialPort::readyRead, this, &TinyBeeController::onReadyRead);
-    connect(&m_serial, &QSerialPort::errorOccurred, this, &TinyBeeController::onErrorOccurred);
+}
+
+TinyBeeController::TinyBeeController(SharedIoThread ioThread, QObject *parent)
+    : QObject(parent),
+      m_ioThread(ioThread.thread),
+      m_requests(new SpscQueue<SerialRequest>(1024)),
+      m_events(new SpscQueue<SerialEvent>(4096)),
+      m_requestBacklog(new QQueue<SerialRequest>)
+{
+    m_requestRetryTimer.setSingleShot(true);
+    m_requestRetryTimer.setInterval(5);
+    connect(&m_requestRetryTimer, &QTimer::timeout, this, &TinyBeeController::flushRequests);
+
+    m_positionTimer.setSingleShot(true);
+    m_activityClock.start();
+    connect(&m_positionTimer, &QTimer::timeout, this, &TinyBeeController::pollPosition);
+
+    if (!m_ioThread)
+    {
+        m_ownThread.reset(new QThread);
+        m_ownThread->setObjectName("TinyBee serial I/O");
+        m_ioThread = m_ownThread.get();
+    }
+
+    m_worker = new SerialWorker(m_requests.get(), m_events.get(), &m_requestWakePending, &m_eventWakePending, this);
+    m_worker->moveToThread(m_ioThread);
+    if (m_ownThread)
+    {
+        connect(m_ownThread.get(), &QThread::finished, m_worker, &QObject::deleteLater);
+        m_ownThread->start();
+    }
 }
 
 TinyBeeController::~TinyBeeController()
 {
     disconnectPort();
+    if (m_ownThread)
+    {
+        m_ownThread->quit();
+        m_ownThread->wait();
+        return;
+    }
+
+    // Shared thread keeps running; the worker must go before the rings it uses
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]()
+                              { delete worker; }, Qt::BlockingQueuedConnection);
 }
 
 bool TinyBeeController::connectPort(const QString &portName, qint32 baudRate)
 {
-    if (m_serial.isOpen())
+    // The port must be opened by the thread that will read from it
+    bool opened = false;
+    QString error;
+    QMetaObject::invokeMethod(m_worker, [&]()
+                              { opened = m_worker->openPort(portName, baudRate, &error); }, Qt::BlockingQueuedConnection);
+
+    if (!opened)
     {
-        m_serial.close();
+        m_hasError = true;
+        QString err = QString("Failed to open serial port %1: %2").arg(portName, error);
+        emit errorOccurred(err);
+        qCritical() << err;
+        m_connected = false;
+        return false;
     }
 
-    m_serial.setPortName(portName);
-    m_serial.setBaudRate(baudRate);
-    m_serial.setDataBits(QSerialPort::Data8);
-    m_serial.setParity(QSerialPort::NoParity);
-    m_serial.setStopBits(QSerialPort::OneStop);
-    m_serial.setFlowControl(QSerialPort::NoFlowControl);
+    m_connected = true;
+    m_hasError = false;
+    m_replaying = false;
+    emit connected();
+    qInfo() << "Serial port opened:" << portName << "at baud" << baudRate;
+    return true;
+}
+
+bool TinyBeeController::connectReplay(const QString &path, double speed)
+{
+    bool opened = false;
+    QString error;
+    QMetaObject::invokeMethod(m_worker, [&]()
+                              { opened = m_worker->openReplay(path, speed, &error); }, Qt::BlockingQueuedConnection);
 
-    if (!m_serial.open(QIODevice::ReadWrite))
+    if (!opened)
     {
         m_hasError = true;
-        QString err = QString("Failed to open serial port %1: %2").arg(portName, m_serial.errorString());
+        QString err = QString("Failed to replay session %1: %2").arg(path, error);
         emit errorOccurred(err);
         qCritical() << err;
         m_connected = false;
         return false;
     }
 
-    // Clear buffers for clean start
-    m_responseBuffer.clear();
-    m_serial.clear(QSerialPort::AllDirections);
-
     m_connected = true;
     m_hasError = false;
+    m_replaying = true;
     emit connected();
-    qInfo() << "Serial port opened:" << portName << "at baud" << baudRate;
+    qInfo() << "Replaying session" << path << "at speed" << speed;
     return true;
 }
 
+bool TinyBeeController::startSessionCapture(const QString &path)
+{
+    bool started = false;
+    QString error;
+    QMetaObject::invokeMethod(m_worker, [&]()
+                              { started = m_worker->startCapture(path, &error); }, Qt::BlockingQueuedConnection);
+
+    if (!started)
+    {
+        QString err = QString("Failed to record session to %1: %2").arg(path, error);
+        emit errorOccurred(err);
+        qCritical() << err;
+    }
+    return started;
+}
+
+void TinyBeeController::stopSessionCapture()
+{
+    QMetaObject::invokeMethod(m_worker, [this]()
+                              { m_worker->stopCapture(); }, Qt::BlockingQueuedConnection);
+}
+
 void TinyBeeController::disconnectPort()
 {
-    if (m_serial.isOpen())
-        m_serial.close();
+    // The port is going away, so M154 cannot (and need not) be switched off
+    m_positionUpdates = false;
+    m_autoReportActive = false;
+    m_positionTimer.stop();
+
+    // Outstanding commands are failed by the worker and reported through drainEvents()
+    QMetaObject::invokeMethod(m_worker, [this]()
+                              { m_worker->closePort("Disconnected"); }, Qt::BlockingQueuedConnection);
 
     m_connected = false;
+    m_replaying = false;
     emit disconnected();
     qInfo() << "Serial port closed";
 }
 
 bool TinyBeeController::isConnected() const
 {
-    return m_connected && m_serial.isOpen();
+    return m_connected;
+}
+
+int TinyBeeController::inFlightCount() const
+{
+    return m_worker->inFlightCount.load(std::memory_order_relaxed);
+}
+
+int TinyBeeController::inFlightBytes() const
+{
+    return m_worker->inFlightBytes.load(std::memory_order_relaxed);
+}
+
+quint64 TinyBeeController::linesWritten() const
+{
+    return m_worker->linesWritten.load(std::memory_order_relaxed);
 }
 
-QString TinyBeeController::buildCommandString(const GCodeCommand &cmd) const
+quint64 TinyBeeController::writeCount() const
 {
-    switch (cmd.type)
+    return m_worker->writeCount.load(std::memory_order_relaxed);
+}
+
+LinkStatistics TinyBeeController::linkStatistics() const
+{
+    return m_worker->statistics();
+}
+
+void TinyBeeController::resetLinkStatistics()
+{
+    m_worker->resetStatistics();
+}
+
+quint64 TinyBeeController::enqueueCommand(const GCodeCommand &cmd, int timeoutMs)
+{
+    if (!m_serializer.serialize(cmd))
     {
-    case GCodeCommandType::FirmwareInfo:
-        return "M115\n";
-    case GCodeCommandType::Home:
-        if (cmd.x == 0 && cmd.y == 0 && cmd.z == 0)
-            return "G28\n"; // Home all axes
-        else
-        {
-            QString axes;
-            if (cmd.x != 0)
-                axes += " X";
-            if (cmd.y != 0)
-                axes += " Y";
-            if (cmd.z != 0)
-                axes += " Z";
-            return QString("G28%1\n").arg(axes);
-        }
-    case GCodeCommandType::Move:
-        return QString("G1 X%1 Y%2 Z%3 F%4\n")
-            .arg(cmd.x, 0, 'f', 3)
-            .arg(cmd.y, 0, 'f', 3)
-            .arg(cmd.z, 0, 'f', 3)
-            .arg(cmd.feedrate);
-    case GCodeCommandType::EmergencyStop:
-        return "M112\n";
-    case GCodeCommandType::Custom:
-        return cmd.customCommand.trimmed() + "\n";
-    default:
-        return QString();
+        qWarning() << "Empty command string built for GCodeCommand";
+        return 0;
     }
+    return enqueueLine(m_serializer.toByteArray(), timeoutMs);
 }
 
-bool TinyBeeController::sendCommand(const GCodeCommand &cmd, QString *response, int timeoutMs)
+quint64 TinyBeeController::enqueueLine(const QByteArray &line, int timeoutMs)
+{
+    quint64 id = submitLine(line, timeoutMs);
+    if (id != 0)
+        noteActivity();
+    return id;
+}
+
+quint64 TinyBeeController::submitLine(const QByteArray &line, int timeoutMs)
 {
     if (!isConnected())
     {
         QString err = "Cannot send command: Not connected to serial port";
         emit errorOccurred(err);
         qWarning() << err;
-        return false;
-    }
-
-    QString cmdStr = buildCommandString(cmd);
-    if (cmdStr.isEmpty())
-    {
-        qWarning() << "Empty command string built for GCodeCommand";
-        return false;
+        return 0;
     }
 
-    QMutexLocker locker(&m_mutex);
-    m_responseBuffer.clear();
+    if (line.trimmed().isEmpty())
+        return 0;
+
+    SerialRequest request;
+    request.type = SerialRequest::Enqueue;
+    request.id = m_nextId++;
+    request.data = line;
+    if (!request.data.endsWith('\n'))
+        request.data.append('\n');
+    request.timeoutMs = timeoutMs;
+    request.queuedNs = LinkStatistics::nowNs();
+
+    const quint64 id = request.id;
+    ++m_pendingCount;
+    emit commandQueued(id, request.data);
+    pushRequest(std::move(request));
+    return id;
+}
 
-    QByteArray data = cmdStr.toUtf8();
-    if (m_serial.write(data) == -1)
+void TinyBeeController::emergencyStop(qint64 requestedNs)
+{
+    if (requestedNs == 0)
+        requestedNs = LinkStatistics::nowNs();
+    if (!isConnected())
     {
-        QString err = QString("Failed to write command to serial port: %1").arg(cmdStr.trimmed());
+        QString err = "Cannot send emergency stop: Not connected to serial port";
         emit errorOccurred(err);
-        qCritical() << err;
-        return false;
+        qWarning() << err;
+        return;
     }
 
-    if (!m_serial.waitForBytesWritten(timeoutMs))
+    QCoreApplication::postEvent(m_worker, new EmergencyStopEvent(requestedNs), Qt::HighEventPriority);
+
+    // The firmware halts on M112; polls would only time out from here on
+    m_positionUpdates = false;
+    m_autoReportActive = false;
+    m_positionTimer.stop();
+
+    // Requests that never made it into the ring are cancelled on this side.
+    // The stop is already posted, so handlers enqueueing more cannot overtake it.
+    QQueue<SerialRequest> cancelled;
+    cancelled.swap(*m_requestBacklog);
+    m_requestRetryTimer.stop();
+    bool reconfigure = false;
+    for (const SerialRequest &request : cancelled)
     {
-        QString err = QString("Timeout waiting for bytes to be written: %1").arg(cmdStr.trimmed());
-        emit errorOccurred(err);
-        qCritical() << err;
-        return false;
+        if (request.type == SerialRequest::Configure)
+        {
+            reconfigure = true;
+        }
+        else if (request.type == SerialRequest::Enqueue)
+        {
+            --m_pendingCount;
+            handleInternalReply(request.id, false, "Emergency stop");
+            emit commandFailed(request.id, "Emergency stop");
+        }
     }
+    if (reconfigure)
+        pushConfiguration();
+}
 
-    QString resp;
-    if (!waitForResponse(resp, timeoutMs))
+void TinyBeeController::clearQueue()
+{
+    SerialRequest request;
+    request.type = SerialRequest::ClearQueue;
+    pushRequest(std::move(request));
+}
+
+void TinyBeeController::cancelCommand(quint64 id)
+{
+    if (id == 0)
+        return;
+    SerialRequest request;
+    request.type = SerialRequest::Cancel;
+    request.id = id;
+    pushRequest(std::move(request));
+}
+
+void TinyBeeController::setStreamingMode(StreamingMode mode)
+{
+    m_streamingMode = mode;
+    pushConfiguration();
+}
+
+void TinyBeeController::setWindowSize(int lines)
+{
+    m_windowSize = qMax(1, lines);
+    pushConfiguration();
+}
+
+void TinyBeeController::setRxBufferSize(int bytes)
+{
+    m_rxBufferSize = qMax(1, bytes);
+    pushConfiguration();
+}
+
+void TinyBeeController::setLineNumbering(bool enabled)
+{
+    m_lineNumbering = enabled;
+    pushConfiguration();
+}
+
+void TinyBeeController::pushConfiguration()
+{
+    SerialRequest request;
+    request.type = SerialRequest::Configure;
+    request.mode = m_streamingMode;
+    request.windowSize = m_windowSize;
+    request.rxBufferSize = m_rxBufferSize;
+    request.lineNumbering = m_lineNumbering;
+    pushRequest(std::move(request));
+}
+
+void TinyBeeController::pushRequest(SerialRequest &&request)
+{
+    // Keep ordering: once the ring was full, later requests wait behind the backlog
+    if (!m_requestBacklog->isEmpty() || !m_requests->tryPush(std::move(request)))
     {
-        QString err = QString("Timeout or incomplete response for command: %1").arg(cmdStr.trimmed());
-        emit errorOccurred(err);
-        qWarning() << err;
-        return false;
+        m_requestBacklog->enqueue(std::move(request));
+        if (!m_requestRetryTimer.isActive())
+            m_requestRetryTimer.start();
     }
 
-    resp = resp.trimmed();
-    if (response)
-        *response = resp;
+    if (!m_requestWakePending.exchange(true))
+        QMetaObject::invokeMethod(m_worker, "drainRequests", Qt::QueuedConnection);
+}
 
-    qInfo() << "Command:" << cmdStr.trimmed() << "; Response:" << resp;
-    return true;
+void TinyBeeController::flushRequests()
+{
+    if (m_requestBacklog->isEmpty())
+        return;
+
+    while (!m_requestBacklog->isEmpty() && m_requests->tryPush(std::move(m_requestBacklog->head())))
+        m_requestBacklog->dequeue();
+
+    if (!m_requestBacklog->isEmpty())
+        m_requestRetryTimer.start();
+
+    if (!m_requestWakePending.exchange(true))
+        QMetaObject::invokeMethod(m_worker, "drainRequests", Qt::QueuedConnection);
 }
 
-bool TinyBeeController::waitForResponse(QString &outResponse, int timeoutMs)
+void TinyBeeController::drainEvents()
 {
-    QElapsedTimer timer;
-    timer.start();
+    // Cleared before draining so an event pushed meanwhile schedules another pass
+    m_eventWakePending.store(false);
 
-    while (timer.elapsed() < timeoutMs)
+    SerialEvent event;
+    while (m_events->tryPop(event))
     {
-        if (m_serial.waitForReadyRead(timeoutMs - timer.elapsed()))
+        switch (event.type)
         {
-            QByteArray newData = m_serial.readAll();
-            m_responseBuffer.append(newData);
-
-            // Customize per device: response done if contains "ok" or ends with newline
-            if (m_responseBuffer.contains("\nok") || m_responseBuffer.endsWith('\n'))
+        case SerialEvent::Completed:
+            --m_pendingCount;
+            handleInternalReply(event.id, true, event.text);
+            emit commandCompleted(event.id, event.text);
+            break;
+        case SerialEvent::Failed:
+            --m_pendingCount;
+            handleInternalReply(event.id, false, event.text);
+            emit commandFailed(event.id, event.text);
+            break;
+        case SerialEvent::LineReceived:
+            emit lineReceived(event.text);
+            break;
+        case SerialEvent::Position:
+            handlePositionReport(event.position);
+            emit positionUpdated(event.position);
+            break;
+        case SerialEvent::Error:
+            emit errorOccurred(event.text);
+            break;
+        case SerialEvent::PortError:
+            m_hasError = true;
+            emit errorOccurred(event.text);
+            break;
+        case SerialEvent::Disconnected:
+            m_hasError = true;
+            m_positionUpdates = false;
+            m_autoReportActive = false;
+            m_positionTimer.stop();
+            if (m_connected)
             {
-                outResponse = QString::fromUtf8(m_responseBuffer);
-                m_responseBuffer.clear();
-                return true;
+                m_connected = false;
+                m_replaying = false;
+                emit disconnected();
             }
+            break;
+        case SerialEvent::ReplayedTx:
+            emit replayLineSent(event.text);
+            break;
+        case SerialEvent::ReplayFinished:
+            emit replayFinished();
+            break;
+        case SerialEvent::EmergencyStopSent:
+            if (event.latencyNs > EmergencyStopTargetNs)
+                qWarning() << "Emergency stop took" << event.latencyNs / 1000 << "us to reach the port, target"
+                           << EmergencyStopTargetNs / 1000 << "us";
+            else
+                qInfo() << "Emergency stop written in" << event.latencyNs / 1000 << "us";
+            emit emergencyStopSent(event.latencyNs);
+            break;
+        case SerialEvent::QueueEmpty:
+            // The worker cannot see requests still waiting in the ring or backlog
+            if (m_pendingCount == 0)
+                emit queueEmpty();
+            break;
         }
     }
 
-    outResponse.clear();
-    return false; // Timeout
+    flushRequests();
 }
 
-void TinyBeeController::onReadyRead()
+bool TinyBeeController::sendCommand(const GCodeCommand &cmd, QString *response, int timeoutMs)
 {
-    QByteArray data = m_serial.readAll();
-    QMutexLocker locker(&m_mutex);
-    m_responseBuffer.append(data);
-}
+    quint64 id = enqueueCommand(cmd, timeoutMs);
+    if (id == 0)
+        return false;
 
-void TinyBeeController::onErrorOccurred(QSerialPort::SerialPortError error)
-{
-    if (error == QSerialPort::NoError)
-        return;
-    QString err = QString("Serial port error: %1").arg(m_serial.errorString());
-    emit errorOccurred(err);
-    qCritical() << err;
-    m_hasError = true;
+    // Completion is always delivered from the event loop, never from inside
+    // enqueueCommand(), so connecting after the enqueue cannot miss it.
+    bool success = false;
+    QString resp;
+    QEventLoop loop;
+    connect(this, &TinyBeeController::commandCompleted, &loop, [&](quint64 doneId, const QString &r)
+            {
+        if (doneId != id)
+            return;
+        success = true;
+        resp = r;
+        loop.quit(); });
+    connect(this, &TinyBeeController::commandFailed, &loop, [&](quint64 failedId, const QString &)
+            {
+        if (failedId == id)
+            loop.quit(); });
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+
+    if (!success)
+        return false;
+
+    if (response)
+        *response = resp;
+
+    m_serializer.serialize(cmd);
+    qInfo() << "Command:" << m_serializer.toByteArray().trimmed() << "; Response:" << resp;
+    return true;
 }
 
 bool TinyBeeController::parseResponse(const QString &response, QHash<QString, QString> &parsed)
@@ -226,28 +488,138 @@ bool TinyBeeController::getPosition(MotorPosition &pos, int timeoutMs)
         return false;
     }
 
-    QHash<QString, QString> parsed;
-    if (!parseResponse(response, parsed))
+    // positionUpdated() was already emitted when the report line arrived
+    const QByteArray bytes = response.toUtf8();
+    for (const QByteArray &line : bytes.split('\n'))
     {
-        qWarning() << "Failed to parse position response:" << response;
-        return false;
+        if (parsePositionReport(std::string_view(line.constData(), size_t(line.size())), pos))
+        {
+            pos.timestampNs = LinkStatistics::nowNs();
+            return true;
+        }
     }
 
-    bool okX, okY, okZ;
-    double xVal = parsed.value("X").toDouble(&okX);
-    double yVal = parsed.value("Y").toDouble(&okY);
-    double zVal = parsed.value("Z").toDouble(&okZ);
+    qWarning() << "Position parse error from response:" << response;
+    return false;
+}
+
+void TinyBeeController::startPositionUpdates(int movingIntervalMs, int idleIntervalMs)
+{
+    if (!isConnected())
+        return;
 
-    if (!okX || !okY || !okZ)
+    m_movingIntervalMs = qMax(10, movingIntervalMs);
+    m_idleIntervalMs = qMax(m_movingIntervalMs, idleIntervalMs);
+    m_positionUpdates = true;
+    m_hasReported = false;
+
+    // Ask for the capability list; the reply decides whether M154 is used
+    if (!m_autoReportActive && m_capabilityQueryId == 0)
+        m_capabilityQueryId = submitLine("M115", 2000);
+
+    m_positionTimer.start(0);
+}
+
+void TinyBeeController::stopPositionUpdates()
+{
+    m_positionUpdates = false;
+    m_positionTimer.stop();
+
+    if (m_autoReportActive && isConnected())
+        submitLine("M154 S0", 2000);
+    m_autoReportActive = false;
+}
+
+void TinyBeeController::queryMotionLimits()
+{
+    if (m_velocityQueryId != 0 || m_accelQueryId != 0)
+        return;
+    m_velocityQueryId = submitLine("M203", 2000);
+    m_accelQueryId = submitLine("M201", 2000);
+}
+
+bool TinyBeeController::isMoving() const
+{
+    // Anything besides our own poll still queued counts as motion
+    if (m_pendingCount > (m_positionPollId != 0 ? 1 : 0))
+        return true;
+    return m_lastActivityMs >= 0 && m_activityClock.elapsed() - m_lastActivityMs < 500;
+}
+
+void TinyBeeController::noteActivity()
+{
+    m_lastActivityMs = m_activityClock.elapsed();
+
+    // Switch to the fast rate now rather than after the idle interval expires
+    if (m_positionUpdates && m_positionTimer.remainingTime() > m_movingIntervalMs)
+        m_positionTimer.start(m_movingIntervalMs);
+}
+
+void TinyBeeController::pollPosition()
+{
+    if (!m_positionUpdates || !isConnected())
+        return;
+
+    const bool moving = isMoving();
+
+    // A single M114 in flight at a time; with auto-report enabled the
+    // firmware covers the idle case on its own. Plain M114 reports where the
+    // planner is headed; with R, Marlin built with M114_REALTIME reports where
+    // the axes are (others ignore the R).
+    if (m_positionPollId == 0 && (moving || !m_autoReportActive))
+        m_positionPollId = submitLine("M114 R", 2000);
+
+    m_positionTimer.start(moving ? m_movingIntervalMs : m_idleIntervalMs);
+}
+
+void TinyBeeController::handlePositionReport(const MotorPosition &pos)
+{
+    if (m_hasReported && (pos.x != m_lastReported.x || pos.y != m_lastReported.y ||
+                          pos.z != m_lastReported.z || pos.e != m_lastReported.e))
+        noteActivity();
+    m_lastReported = pos;
+    m_hasReported = true;
+}
+
+void TinyBeeController::handleInternalReply(quint64 id, bool success, const QString &response)
+{
+    if (id == m_positionPollId)
     {
-        qWarning() << "Position parse error from response:" << response;
-        return false;
+        m_positionPollId = 0;
+        return;
+    }
+
+    if (id == m_velocityQueryId || id == m_accelQueryId)
+    {
+        // Marlin prints the current settings as "echo:  M203 X... Y... Z..." before "ok"
+        if (success)
+        {
+            const QByteArray bytes = response.toUtf8();
+            for (const QByteArray &line : bytes.split('\n'))
+                MotionPlanner::parseLimitsReport(std::string_view(line.constData(), size_t(line.size())), m_motionLimits);
+        }
+        if (id == m_velocityQueryId)
+            m_velocityQueryId = 0;
+        else
+            m_accelQueryId = 0;
+        if (m_velocityQueryId == 0 && m_accelQueryId == 0)
+            emit motionLimitsReceived(m_motionLimits);
+        return;
     }
 
-    pos.x = xVal;
-    pos.y = yVal;
-    pos.z = zVal;
+    if (id != m_capabilityQueryId)
+        return;
+    m_capabilityQueryId = 0;
 
-    emit positionUpdated(pos);
-    return true;
+    // Marlin lists "Cap:AUTOREPORT_POS:1" in its M115 reply. M154 takes whole
+    // seconds, so it only replaces idle polling; motion is still polled.
+    if (success && m_positionUpdates && response.contains("Cap:AUTOREPORT_POS:1"))
+    {
+        const int seconds = qMax(1, (m_idleIntervalMs + 999) / 1000);
+        if (submitLine(QByteArray("M154 S") + QByteArray::number(seconds), 2000) != 0)
+        {
+            m_autoReportActive = true;
+            emit logMessage(QString("Firmware position auto-report enabled (M154 S%1)").arg(seconds));
+        }
+    }
 }
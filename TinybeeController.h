@@ -3,10 +3,16 @@
 #define TINYBEECONTROLLER_H
 
 #include <QObject>
-#include <QSerialPort>
+#include <QThread>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QHash>
-#include <QMutex>
+#include <QQueue>
+#include <atomic>
+#include <memory>
+#include "GCodeSerializer.h"
+#include "LinkStatistics.h"
+#include "MotionPlanner.h"
 
 // Motor position representation
 struct MotorPosition
@@ -14,6 +20,15 @@ struct MotorPosition
     double x = 0.0;
     double y = 0.0;
     double z = 0.0;
+    double e = 0.0;
+
+    // Stepper counts from the "Count" section of an M114 report
+    qint64 countX = 0;
+    qint64 countY = 0;
+    qint64 countZ = 0;
+    bool hasCounts = false;
+
+    qint64 timestampNs = 0; // LinkStatistics::nowNs() when the report arrived (0 = unknown)
 };
 
 // Enumerate command types with data encapsulation
@@ -26,6 +41,14 @@ enum class GCodeCommandType
     Custom
 };
 
+// How many commands may be outstanding on the link at once
+enum class StreamingMode
+{
+    SendAndWait,      // One command at a time, next line after the previous ok
+    Windowed,         // Up to windowSize() unacknowledged lines
+    CharacterCounting // Unacknowledged bytes kept within the firmware RX buffer (GRBL style)
+};
+
 // Command container
 struct GCodeCommand
 {
@@ -36,11 +59,31 @@ struct GCodeCommand
     QString customCommand;
 };
 
+class SerialWorker;
+struct SerialRequest;
+struct SerialEvent;
+template <typename T>
+class SpscQueue;
+
+// Names the I/O thread for TinyBeeController(SharedIoThread, parent), so a
+// QThread* can never be taken for the parent by overload resolution
+struct SharedIoThread
+{
+    QThread *thread = nullptr;
+};
+
+// GUI-thread facade over the serial link. The port, the send window and ack
+// matching run in a dedicated I/O thread (SerialWorker); commands travel there
+// and events come back through lock-free SPSC queues. All public methods must
+// be called from the thread that owns the controller.
 class TinyBeeController : public QObject
 {
     Q_OBJECT
 public:
     explicit TinyBeeController(QObject *parent = nullptr);
+    // Runs the serial worker on an existing thread shared with other
+    // controllers (see ControllerManager); the thread must outlive this object
+    explicit TinyBeeController(SharedIoThread ioThread, QObject *parent = nullptr);
     ~TinyBeeController();
 
     // Serial port management
@@ -48,7 +91,63 @@ public:
     void disconnectPort();
     bool isConnected() const;
 
-    // Command handling
+    // Plays a session recorded with startSessionCapture() in place of a port:
+    // received lines, position reports and the log behave as they did live.
+    // speed scales the recorded timing (10 = ten times faster, 0 = unpaced).
+    // Ends with replayFinished(); disconnectPort() stops it early.
+    bool connectReplay(const QString &path, double speed = 1.0);
+    bool isReplaying() const { return m_replaying; }
+    // Records the raw RX/TX bytes of the link, with timestamps, until stopped
+    bool startSessionCapture(const QString &path);
+    void stopSessionCapture();
+
+    // Asynchronous command handling. Commands are written in queue order and
+    // acknowledged in the same order; the returned id is reported back through
+    // commandCompleted() or commandFailed(). Returns 0 if the command was rejected.
+    quint64 enqueueCommand(const GCodeCommand &cmd, int timeoutMs = 2000);
+    quint64 enqueueLine(const QByteArray &line, int timeoutMs = 2000);
+    int pendingCount() const { return m_pendingCount; }
+    // Out-of-band stop. M112 bypasses the command queue: it is written by the
+    // I/O thread ahead of anything queued, after discarding the port's output
+    // buffer, and every pending command fails with "Emergency stop".
+    // emergencyStopSent() reports the time from requestedNs (the button
+    // press; 0 = now) until the bytes were handed to the driver.
+    void emergencyStop(qint64 requestedNs = 0);
+    static constexpr qint64 EmergencyStopTargetNs = 5000000; // Press to wire, logged when exceeded
+    int inFlightCount() const;
+    int inFlightBytes() const;
+    // Lines written so far and the port writes that carried them
+    quint64 linesWritten() const;
+    quint64 writeCount() const;
+    // Queued/written/acked latency histograms per command kind and byte rates;
+    // linkStatistics().toText() gives a printable snapshot
+    LinkStatistics linkStatistics() const;
+    void resetLinkStatistics();
+    // Cancels every command not yet written, whoever queued it (position
+    // polls and queries included)
+    void clearQueue();
+    // Cancels one command if it has not been written yet; once on the wire it
+    // completes or fails as usual
+    void cancelCommand(quint64 id);
+
+    // Streaming configuration; acknowledgements are always matched in FIFO order
+    void setStreamingMode(StreamingMode mode);
+    StreamingMode streamingMode() const { return m_streamingMode; }
+    void setWindowSize(int lines);
+    int windowSize() const { return m_windowSize; }
+    void setRxBufferSize(int bytes);
+    int rxBufferSize() const { return m_rxBufferSize; }
+    // Marlin "N<line> <command>*<checksum>" framing. Lines the firmware rejects
+    // are resent from the in-flight window when it answers "Resend:", so
+    // corruption costs a retransmission instead of a timeout. Numbering starts
+    // with an M110 before the first framed line.
+    void setLineNumbering(bool enabled);
+    bool lineNumbering() const { return m_lineNumbering; }
+
+    // Number formatting used for Move commands (decimals per axis)
+    GCodeSerializer &serializer() { return m_serializer; }
+
+    // Blocking convenience wrapper around enqueueCommand()
     bool sendCommand(const GCodeCommand &cmd, QString *response = nullptr, int timeoutMs = 2000);
 
     // Parse key:value responses to map
@@ -57,6 +156,20 @@ public:
     // Retrieve motor position (M114)
     bool getPosition(MotorPosition &pos, int timeoutMs = 2000);
 
+    // Continuous position updates through positionUpdated(). M114 is polled
+    // at movingIntervalMs while commands are running or the position is
+    // changing, and at idleIntervalMs otherwise, as "M114 R" (the real-time
+    // position where the firmware supports it). If M115 reports
+    // AUTOREPORT_POS, Marlin's M154 auto-report replaces idle polling.
+    void startPositionUpdates(int movingIntervalMs = 50, int idleIntervalMs = 1000);
+    void stopPositionUpdates();
+    bool autoReportActive() const { return m_autoReportActive; }
+
+    // Reads max feedrates (M203) and accelerations (M201) back from the
+    // firmware; motionLimitsReceived() fires once both replies are in
+    void queryMotionLimits();
+    const MotionLimits &motionLimits() const { return m_motionLimits; }
+
     // Status query
     bool connected() const { return m_connected; }
     bool hasError() const { return m_hasError; }
@@ -67,21 +180,72 @@ signals:
     void errorOccurred(const QString &error);
     void positionUpdated(const MotorPosition &pos);
     void logMessage(const QString &msg);
+    void lineReceived(const QString &line);
+    void motionLimitsReceived(const MotionLimits &limits);
+    void replayLineSent(const QString &line); // TX side of a replayed session
+    void replayFinished();
+
+    void emergencyStopSent(qint64 latencyNs);
+
+    void commandQueued(quint64 id, const QByteArray &line);
+    void commandCompleted(quint64 id, const QString &response);
+    void commandFailed(quint64 id, const QString &error);
+    void queueEmpty();
 
 private slots:
-    void onReadyRead();
-    void onErrorOccurred(QSerialPort::SerialPortError error);
+    void drainEvents();
+    void flushRequests();
+    void pollPosition();
 
 private:
-    QSerialPort m_serial;
-    QByteArray m_responseBuffer;
-    QMutex m_mutex; // Thread safety
+    std::unique_ptr<QThread> m_ownThread; // Only when not sharing a thread
+    QThread *m_ioThread;
+    SerialWorker *m_worker;
+    std::unique_ptr<SpscQueue<SerialRequest>> m_requests;
+    std::unique_ptr<SpscQueue<SerialEvent>> m_events;
+    std::unique_ptr<QQueue<SerialRequest>> m_requestBacklog; // Requests that did not fit in the ring
+    std::atomic<bool> m_requestWakePending{false};
+    std::atomic<bool> m_eventWakePending{false};
+    QTimer m_requestRetryTimer;
+
+    GCodeSerializer m_serializer;
+    quint64 m_nextId = 1;
+    int m_pendingCount = 0;
+
+    StreamingMode m_streamingMode = StreamingMode::SendAndWait;
+    int m_windowSize = 4;     // Marlin's default BUFSIZE
+    int m_rxBufferSize = 127; // GRBL's RX buffer minus one
+    bool m_lineNumbering = false;
 
     bool m_connected = false;
     bool m_hasError = false;
-
-    QString buildCommandString(const GCodeCommand &cmd) const;
-    bool waitForResponse(QString &outResponse, int timeoutMs);
+    bool m_replaying = false;
+
+    // Position updates
+    QTimer m_positionTimer;
+    QElapsedTimer m_activityClock;
+    bool m_positionUpdates = false;
+    bool m_autoReportActive = false;
+    int m_movingIntervalMs = 50;
+    int m_idleIntervalMs = 1000;
+    quint64 m_positionPollId = 0;
+    quint64 m_capabilityQueryId = 0;
+    qint64 m_lastActivityMs = -1; // Last command sent or position change
+    MotorPosition m_lastReported;
+    bool m_hasReported = false;
+
+    MotionLimits m_motionLimits;
+    quint64 m_velocityQueryId = 0;
+    quint64 m_accelQueryId = 0;
+
+    quint64 submitLine(const QByteArray &line, int timeoutMs);
+    void pushRequest(SerialRequest &&request);
+    void pushConfiguration();
+
+    bool isMoving() const;
+    void noteActivity();
+    void handlePositionReport(const MotorPosition &pos);
+    void handleInternalReply(quint64 id, bool success, const QString &response);
 };
 
 #endif // TINYBEECONTROLLER_H
@@ -0,0 +1,105 @@
+// BenchHarness.h
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <QString>
+#include <QVector>
+#include <QIODevice>
+#include <chrono>
+#include <cstdio>
+
+// Minimal timing harness for the protocol microbenchmarks. Each case runs in
+// doubling batches until it has been measured for at least minTimeMs.
+struct BenchResult
+{
+    QString group;
+    QString name;
+    qint64 iterations = 0;
+    double nsPerOp = 0.0;
+
+    double opsPerSec() const { return nsPerOp > 0.0 ? 1e9 / nsPerOp : 0.0; }
+};
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(int minTimeMs = 300) : m_minTimeMs(minTimeMs) {}
+
+    // op() is called once per iteration and returns a value folded into a
+    // checksum so the compiler cannot discard the work
+    // Only cases whose "group/name" contains filter are run
+    void setFilter(const QString &filter) { m_filter = filter; }
+    bool selected(const QString &group, const QString &name) const
+    {
+        return m_filter.isEmpty() || (group + '/' + name).contains(m_filter, Qt::CaseInsensitive);
+    }
+
+    template <typename Op>
+    const BenchResult &run(const QString &group, const QString &name, Op &&op)
+    {
+        using Clock = std::chrono::steady_clock;
+        if (!selected(group, name))
+            return m_skipped;
+
+        qint64 batch = 1;
+        qint64 total = 0;
+        double elapsedNs = 0.0;
+        while (elapsedNs < m_minTimeMs * 1e6)
+        {
+            Clock::time_point start = Clock::now();
+            for (qint64 i = 0; i < batch; ++i)
+                m_sink += size_t(op());
+            elapsedNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            total += batch;
+            batch *= 2;
+        }
+
+        return report(group, name, total, elapsedNs);
+    }
+
+    // Records a case timed by the caller (end-to-end runs that cannot loop per op)
+    const BenchResult &report(const QString &group, const QString &name, qint64 iterations, double elapsedNs)
+    {
+        if (!selected(group, name))
+            return m_skipped;
+
+        BenchResult result;
+        result.group = group;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerOp = iterations > 0 ? elapsedNs / double(iterations) : 0.0;
+        m_results.append(result);
+
+        std::printf("%-14s %-36s %12.1f ns/op %14.0f ops/s\n",
+                    qPrintable(group), qPrintable(name), result.nsPerOp, result.opsPerSec());
+        std::fflush(stdout);
+        return m_results.last();
+    }
+
+    const QVector<BenchResult> &results() const { return m_results; }
+    size_t checksum() const { return m_sink; }
+
+    // Machine-readable results for regression tracking (see BenchMain.cpp)
+    bool writeJson(QIODevice *device) const;
+
+private:
+    int m_minTimeMs;
+    size_t m_sink = 0;
+    QString m_filter;
+    QVector<BenchResult> m_results;
+    BenchResult m_skipped;
+};
+
+void runSerializerBenchmarks(BenchRunner &runner);
+void runPositionParserBenchmarks(BenchRunner &runner);
+void runMotionPlannerBenchmarks(BenchRunner &runner);
+void runPositionEstimatorBenchmarks(BenchRunner &runner);
+void runControllerManagerBenchmarks(BenchRunner &runner);
+void runSessionReplayBenchmarks(BenchRunner &runner);
+void runEmergencyStopBenchmarks(BenchRunner &runner);
+void runLineFramerBenchmarks(BenchRunner &runner);
+void runResponseParserBenchmarks(BenchRunner &runner);
+void runLogModelBenchmarks(BenchRunner &runner);
+void runLatencyHistogramBenchmarks(BenchRunner &runner);
+
+#endif // BENCHHARNESS_H
@@ -0,0 +1,94 @@
+// BenchMain.cpp
+#include "BenchHarness.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <cstdlib>
+#include <cstring>
+
+bool BenchRunner::writeJson(QIODevice *device) const
+{
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    context["qt_version"] = QString(qVersion());
+    context["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+    context["kernel"] = QSysInfo::kernelType() + ' ' + QSysInfo::kernelVersion();
+    context["min_time_ms"] = m_minTimeMs;
+#ifdef NDEBUG
+    context["build_type"] = "release";
+#else
+    context["build_type"] = "debug";
+#endif
+
+    QJsonArray benchmarks;
+    for (const BenchResult &result : m_results)
+    {
+        QJsonObject entry;
+        entry["group"] = result.group;
+        entry["name"] = result.name;
+        entry["iterations"] = double(result.iterations);
+        entry["ns_per_op"] = result.nsPerOp;
+        entry["ops_per_sec"] = result.opsPerSec();
+        benchmarks.append(entry);
+    }
+
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = benchmarks;
+    return device->write(QJsonDocument(root).toJson()) >= 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // The multi-board case needs an event loop and serial ports
+    QCoreApplication app(argc, argv);
+
+    int minTimeMs = 300;
+    QString filter;
+    QString jsonPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            minTimeMs = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = QString::fromLocal8Bit(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = QString::fromLocal8Bit(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--min-time ms] [--filter text] [--json file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    BenchRunner runner(minTimeMs);
+    runner.setFilter(filter);
+    runSerializerBenchmarks(runner);
+    runResponseParserBenchmarks(runner);
+    runPositionParserBenchmarks(runner);
+    runLineFramerBenchmarks(runner);
+    runLogModelBenchmarks(runner);
+    runLatencyHistogramBenchmarks(runner);
+    runMotionPlannerBenchmarks(runner);
+    runPositionEstimatorBenchmarks(runner);
+    runControllerManagerBenchmarks(runner);
+    runSessionReplayBenchmarks(runner);
+    runEmergencyStopBenchmarks(runner);
+
+    std::printf("checksum %zu\n", runner.checksum());
+
+    if (!jsonPath.isEmpty())
+    {
+        QFile file(jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !runner.writeJson(&file))
+        {
+            std::fprintf(stderr, "Failed to write %s\n", qPrintable(jsonPath));
+            return 1;
+        }
+    }
+    return 0;
+}
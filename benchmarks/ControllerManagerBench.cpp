@@ -0,0 +1,145 @@
+// ControllerManagerBench.cpp
+#include "BenchHarness.h"
+#include "ControllerManager.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr int CommandsPerBoard = 5000;
+
+// Minimal firmware stand-in: one pty per board, "ok" for every received line
+class PtyResponder
+{
+public:
+    explicit PtyResponder(int boards)
+    {
+        for (int i = 0; i < boards; ++i)
+        {
+            const int fd = posix_openpt(O_RDWR | O_NOCTTY);
+            if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+            {
+                if (fd >= 0)
+                    ::close(fd);
+                continue;
+            }
+            termios tio;
+            if (tcgetattr(fd, &tio) == 0)
+            {
+                cfmakeraw(&tio);
+                tcsetattr(fd, TCSANOW, &tio);
+            }
+            m_masters.push_back(fd);
+            m_slaveNames.append(QString::fromLocal8Bit(ptsname(fd)));
+        }
+        m_thread = std::thread([this]()
+                               { serve(); });
+    }
+
+    ~PtyResponder()
+    {
+        m_stop.store(true);
+        m_thread.join();
+        for (int fd : m_masters)
+            ::close(fd);
+    }
+
+    const QStringList &slaveNames() const { return m_slaveNames; }
+
+private:
+    std::vector<int> m_masters;
+    QStringList m_slaveNames;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+
+    void serve()
+    {
+        std::vector<pollfd> fds;
+        for (int fd : m_masters)
+            fds.push_back({fd, POLLIN, 0});
+
+        char buffer[4096];
+        QByteArray reply;
+        while (!m_stop.load())
+        {
+            if (::poll(fds.data(), nfds_t(fds.size()), 20) <= 0)
+                continue;
+            for (pollfd &p : fds)
+            {
+                if (!(p.revents & POLLIN))
+                    continue;
+                const ssize_t n = ::read(p.fd, buffer, sizeof(buffer));
+                reply.clear();
+                for (ssize_t i = 0; i < n; ++i)
+                {
+                    if (buffer[i] == '\n')
+                        reply.append("ok\n");
+                }
+                if (!reply.isEmpty() && ::write(p.fd, reply.constData(), size_t(reply.size())) < 0)
+                    continue;
+            }
+        }
+    }
+};
+} // namespace
+
+void runControllerManagerBenchmarks(BenchRunner &runner)
+{
+    if (!QCoreApplication::instance())
+        return;
+
+    for (int boards : {1, 2, 4, 8, 16})
+    {
+        const QString name = QString("%1 board(s), window 4").arg(boards);
+        if (!runner.selected("manager", name))
+            continue;
+
+        PtyResponder responder(boards);
+        if (responder.slaveNames().size() != boards)
+        {
+            std::printf("manager        skipped: could not open %d pseudo-terminals\n", boards);
+            return;
+        }
+
+        ControllerManager manager;
+        for (int i = 0; i < boards; ++i)
+            manager.addDevice(QString("board%1").arg(i), responder.slaveNames().at(i));
+        if (manager.connectAll() != boards)
+        {
+            std::printf("manager        skipped: could not open %d pseudo-terminals\n", boards);
+            return;
+        }
+        for (int i = 0; i < boards; ++i)
+        {
+            manager.controller(i)->setStreamingMode(StreamingMode::Windowed);
+            manager.controller(i)->setWindowSize(4);
+        }
+
+        QEventLoop loop;
+        QObject::connect(&manager, &ControllerManager::allIdle, &loop, &QEventLoop::quit);
+        QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+
+        QElapsedTimer clock;
+        clock.start();
+        for (int n = 0; n < CommandsPerBoard; ++n)
+            manager.broadcastLine("G1 X1.000 Y2.000 F3000");
+        loop.exec();
+        const double elapsedNs = double(clock.nsecsElapsed());
+
+        qint64 completed = 0;
+        for (const DeviceStatus &status : manager.statusAll())
+            completed += qint64(status.completed);
+        runner.report("manager", name, completed, elapsedNs);
+        manager.disconnectAll();
+    }
+}
@@ -0,0 +1,114 @@
+// EmergencyStopBench.cpp
+#include "BenchHarness.h"
+#include "LatencyHistogram.h"
+#include "TinybeeController.h"
+#include "simulator/FirmwareSimulator.h"
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace
+{
+constexpr int Rounds = 50;
+constexpr int QueuedLines = 500;
+
+void wait(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+} // namespace
+
+// Stop latency with a full host queue: a window of moves in flight, hundreds
+// more queued behind it, and the simulator busy executing. "written" is the
+// press until M112 was handed to the driver, "received" until the firmware
+// read it off the pseudo-terminal.
+void runEmergencyStopBenchmarks(BenchRunner &runner)
+{
+    const QString writtenName = QString("press to written, %1 lines queued").arg(QueuedLines);
+    const QString receivedName = QString("press to received, %1 lines queued").arg(QueuedLines);
+    if (!QCoreApplication::instance() || (!runner.selected("estop", writtenName) && !runner.selected("estop", receivedName)))
+        return;
+
+    SimulatorConfig config;
+    config.moveTimeMs = 5;
+    FirmwareSimulator simulator(config);
+    QString error;
+    if (!simulator.open(&error))
+    {
+        std::printf("estop          skipped: %s\n", qPrintable(error));
+        return;
+    }
+
+    TinyBeeController controller;
+    controller.setStreamingMode(StreamingMode::Windowed);
+    controller.setWindowSize(8);
+    if (!controller.connectPort(simulator.portName()))
+        return;
+
+    qint64 requestedNs = 0;
+    qint64 writtenNs = 0;
+    qint64 receivedNs = 0;
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    QObject::connect(&controller, &TinyBeeController::emergencyStopSent, [&](qint64 latencyNs)
+                     {
+        writtenNs = requestedNs + latencyNs;
+        if (receivedNs != 0)
+            loop.quit(); });
+    QObject::connect(&simulator, &FirmwareSimulator::commandReceived, [&](const QByteArray &line)
+                     {
+        if (line != "M112" || requestedNs == 0)
+            return;
+        receivedNs = LinkStatistics::nowNs();
+        if (writtenNs != 0)
+            loop.quit(); });
+
+    LatencyHistogram written;
+    LatencyHistogram received;
+    double writtenTotalNs = 0.0;
+    double receivedTotalNs = 0.0;
+    for (int round = 0; round < Rounds; ++round)
+    {
+        for (int i = 0; i < QueuedLines; ++i)
+            controller.enqueueLine(QByteArray("G1 X") + QByteArray::number(i % 100) + " F6000", 10000);
+        wait(20); // Window full, firmware moving
+
+        writtenNs = 0;
+        receivedNs = 0;
+        requestedNs = LinkStatistics::nowNs();
+        controller.emergencyStop(requestedNs);
+        timeout.start(1000);
+        loop.exec();
+        timeout.stop();
+        if (writtenNs == 0 || receivedNs == 0)
+        {
+            std::printf("estop          stop not seen within 1 s in round %d\n", round);
+            break;
+        }
+
+        written.record(quint64(writtenNs - requestedNs) / 1000);
+        received.record(quint64(receivedNs - requestedNs) / 1000);
+        writtenTotalNs += double(writtenNs - requestedNs);
+        receivedTotalNs += double(receivedNs - requestedNs);
+        requestedNs = 0;
+
+        // Cancelled commands are reported before the next round queues more
+        while (controller.pendingCount() > 0)
+            wait(1);
+    }
+
+    if (written.count() > 0)
+    {
+        runner.report("estop", writtenName, qint64(written.count()), writtenTotalNs);
+        runner.report("estop", receivedName, qint64(received.count()), receivedTotalNs);
+        std::printf("               p99 written %llu us, received %llu us (target %lld us)\n",
+                    static_cast<unsigned long long>(written.percentile(99)),
+                    static_cast<unsigned long long>(received.percentile(99)),
+                    static_cast<long long>(TinyBeeController::EmergencyStopTargetNs / 1000));
+    }
+    controller.disconnectPort();
+}
@@ -0,0 +1,34 @@
+// LatencyHistogramBench.cpp
+#include "BenchHarness.h"
+#include "LinkStatistics.h"
+#include <random>
+
+void runLatencyHistogramBenchmarks(BenchRunner &runner)
+{
+    // Ack round trips spread over three orders of magnitude
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> distribution(7.0, 1.0);
+    QVector<quint64> samples;
+    samples.reserve(4096);
+    for (int i = 0; i < 4096; ++i)
+        samples.append(quint64(distribution(rng)));
+    int index = 0;
+
+    LatencyHistogram histogram;
+    runner.run("histogram", "LatencyHistogram::record", [&]()
+               {
+        histogram.record(samples[index++ & 4095]);
+        return histogram.count(); });
+
+    runner.run("histogram", "percentile(99)", [&]()
+               { return histogram.percentile(99); });
+
+    LinkStatistics stats;
+    stats.reset();
+    const qint64 now = LinkStatistics::nowNs();
+    runner.run("histogram", "LinkStatistics::recordAck", [&]()
+               {
+        const quint64 us = samples[index++ & 4095];
+        stats.recordAck(LinkStatistics::Motion, now, now + qint64(us) * 500, now + qint64(us) * 1000, true);
+        return stats.kinds[LinkStatistics::Motion].completed; });
+}
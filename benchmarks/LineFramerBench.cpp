@@ -0,0 +1,72 @@
+// LineFramerBench.cpp
+#include "BenchHarness.h"
+#include "LineFramer.h"
+#include <QByteArray>
+
+namespace
+{
+constexpr int ChunkSize = 64; // One full-speed USB CDC packet
+
+// Typical streaming traffic: acknowledgements, position reports, the odd echo
+QByteArray makeStream(int lines)
+{
+    QByteArray stream;
+    for (int i = 0; i < lines; ++i)
+    {
+        switch (i % 8)
+        {
+        case 3:
+            stream += "X:" + QByteArray::number(i % 300) + ".25 Y:12.50 Z:0.40 E:0.00 Count X:" +
+                      QByteArray::number((i % 300) * 80) + " Y:1000 Z:160\r\n";
+            break;
+        case 6:
+            stream += "echo:busy: processing\n";
+            break;
+        default:
+            stream += "ok\n";
+            break;
+        }
+    }
+    return stream;
+}
+
+// MotorControlWidget::handleSerialRead() before LineFramer: a growing QByteArray
+int legacyFrame(QByteArray &buffer, const char *data, int size)
+{
+    int lines = 0;
+    buffer.append(data, size);
+    int newline;
+    while ((newline = buffer.indexOf('\n')) >= 0)
+    {
+        const QByteArray line = buffer.left(newline).trimmed();
+        buffer.remove(0, newline + 1);
+        lines += line.isEmpty() ? 0 : 1;
+    }
+    return lines;
+}
+} // namespace
+
+void runLineFramerBenchmarks(BenchRunner &runner)
+{
+    const QByteArray stream = makeStream(4096);
+    const int chunks = stream.size() / ChunkSize;
+    int index = 0;
+
+    // One op = one 64-byte chunk framed into whatever lines it completes
+    QByteArray buffer;
+    runner.run("framing", "legacy QByteArray indexOf + remove", [&]()
+               {
+        const int offset = (index++ % chunks) * ChunkSize;
+        return legacyFrame(buffer, stream.constData() + offset, ChunkSize); });
+
+    LineFramer framer;
+    runner.run("framing", "LineFramer append + nextLine", [&]()
+               {
+        const int offset = (index++ % chunks) * ChunkSize;
+        framer.append(stream.constData() + offset, ChunkSize);
+        int lines = 0;
+        std::string_view line;
+        while (framer.nextLine(line))
+            lines += int(line.size());
+        return lines; });
+}
@@ -0,0 +1,73 @@
+// LogModelBench.cpp
+#include "BenchHarness.h"
+#include "SerialLogModel.h"
+
+namespace
+{
+QVector<SerialLogModel::Entry> makeEntries(int count)
+{
+    QVector<SerialLogModel::Entry> entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        switch (i % 4)
+        {
+        case 0:
+            entries.append(SerialLogModel::makeEntry(SerialLogModel::Tx, SerialLogModel::Normal,
+                                                     QString("G1 X%1.000 Y12.500 F3000").arg(i % 300)));
+            break;
+        case 1:
+            entries.append(SerialLogModel::makeEntry(SerialLogModel::Rx, SerialLogModel::Ok, "ok"));
+            break;
+        case 2:
+            entries.append(SerialLogModel::makeEntry(SerialLogModel::Tx, SerialLogModel::Normal, "M114"));
+            break;
+        default:
+            entries.append(SerialLogModel::makeEntry(SerialLogModel::Rx, SerialLogModel::Normal,
+                                                     QString("X:%1.00 Y:12.50 Z:0.40 E:0.00 Count X:%2 Y:1000 Z:160")
+                                                         .arg(i % 300)
+                                                         .arg((i % 300) * 80)));
+            break;
+        }
+    }
+    return entries;
+}
+
+void fill(SerialLogModel &model, const QVector<SerialLogModel::Entry> &entries)
+{
+    while (model.totalEntries() < model.maxEntries())
+        model.appendBatch(entries);
+}
+} // namespace
+
+void runLogModelBenchmarks(BenchRunner &runner)
+{
+    const QVector<SerialLogModel::Entry> entries = makeEntries(1024);
+    int index = 0;
+
+    // The log is kept full so every append also evicts the oldest entry
+    SerialLogModel single;
+    fill(single, entries);
+    runner.run("status-log", "append, full log", [&]()
+               {
+        const SerialLogModel::Entry &entry = entries[index++ & 1023];
+        single.append(entry.direction, entry.severity, entry.text);
+        return single.totalEntries(); });
+
+    SerialLogModel batched;
+    fill(batched, entries);
+    QVector<SerialLogModel::Entry> batch = entries.mid(0, 32);
+    runner.run("status-log", "appendBatch, 32 entries", [&]()
+               { return batched.appendBatch(batch) + batched.totalEntries(); });
+
+    SerialLogModel filtered;
+    filtered.setHideChatter(true);
+    fill(filtered, entries);
+    runner.run("status-log", "appendBatch, 32 entries, chatter hidden", [&]()
+               { return filtered.appendBatch(batch) + filtered.rowCount(); });
+
+    runner.run("status-log", "data(DisplayRole)", [&]()
+               {
+        const QModelIndex row = batched.index(index++ % batched.rowCount());
+        return batched.data(row, Qt::DisplayRole).toString().size(); });
+}
@@ -0,0 +1,150 @@
+// MotionPlannerBench.cpp
+#include "BenchHarness.h"
+#include "MotionPlanner.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr int SegmentCount = 1024;
+
+// Array-of-structs planner with the same passes, kept as the layout baseline
+struct AosSegment
+{
+    double unit[3];
+    double length;
+    double cruise;
+    double accel;
+    double entry;
+    double time;
+};
+
+double planAos(std::vector<AosSegment> &segments, double deviation)
+{
+    const size_t n = segments.size();
+    segments[0].entry = 0.0;
+    for (size_t i = 1; i < n; ++i)
+    {
+        const AosSegment &prev = segments[i - 1];
+        AosSegment &cur = segments[i];
+        const double cosTheta = -(prev.unit[0] * cur.unit[0] + prev.unit[1] * cur.unit[1] + prev.unit[2] * cur.unit[2]);
+        const double limit = std::min(prev.cruise, cur.cruise);
+        double junction = limit;
+        if (cosTheta > 0.999999)
+            junction = 0.05;
+        else if (cosTheta >= -0.999999)
+        {
+            const double sinHalf = std::sqrt(0.5 * (1.0 - cosTheta));
+            junction = std::sqrt(cur.accel * deviation * sinHalf / (1.0 - sinHalf));
+        }
+        cur.entry = std::max(0.05, std::min(junction, limit));
+    }
+
+    double exitSpeed = 0.0;
+    for (size_t i = n; i-- > 0;)
+    {
+        AosSegment &s = segments[i];
+        s.entry = std::min(s.entry, std::sqrt(exitSpeed * exitSpeed + 2.0 * s.accel * s.length));
+        exitSpeed = s.entry;
+    }
+    for (size_t i = 1; i < n; ++i)
+    {
+        const AosSegment &prev = segments[i - 1];
+        segments[i].entry = std::min(segments[i].entry, std::sqrt(prev.entry * prev.entry + 2.0 * prev.accel * prev.length));
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        AosSegment &s = segments[i];
+        const double v0 = s.entry;
+        const double v1 = i + 1 < n ? segments[i + 1].entry : 0.0;
+        const double a = s.accel;
+        const double da = (s.cruise * s.cruise - v0 * v0) / (2.0 * a);
+        const double dd = (s.cruise * s.cruise - v1 * v1) / (2.0 * a);
+        if (da + dd <= s.length)
+            s.time = (s.cruise - v0) / a + (s.cruise - v1) / a + (s.length - da - dd) / s.cruise;
+        else
+        {
+            const double vp = std::sqrt(0.5 * (2.0 * a * s.length + v0 * v0 + v1 * v1));
+            s.time = (vp - v0) / a + (vp - v1) / a;
+        }
+        total += s.time;
+    }
+    return total;
+}
+
+void fillPlanner(MotionPlanner &planner)
+{
+    // Short segments along a wobbling path, similar to a dense CAM toolpath
+    planner.clear();
+    planner.setStartPosition(0.0, 0.0, 0.0);
+    for (int i = 0; i < SegmentCount; ++i)
+    {
+        const double t = i * 0.05;
+        planner.addMove(t * 2.0, 5.0 * std::sin(t), 0.01 * (i % 20), 1200.0 + (i % 9) * 300.0);
+    }
+}
+} // namespace
+
+void runMotionPlannerBenchmarks(BenchRunner &runner)
+{
+    MotionPlanner planner;
+    planner.reserve(SegmentCount);
+    fillPlanner(planner);
+
+    // Same path and limits in array-of-structs form
+    const MotionLimits limits;
+    std::vector<AosSegment> aos(SegmentCount);
+    {
+        double px = 0.0, py = 0.0, pz = 0.0;
+        for (int i = 0; i < SegmentCount; ++i)
+        {
+            const double t = i * 0.05;
+            const double x = t * 2.0, y = 5.0 * std::sin(t), z = 0.01 * (i % 20);
+            const double dx = x - px, dy = y - py, dz = z - pz;
+            const double length = std::sqrt(dx * dx + dy * dy + dz * dz);
+            AosSegment &s = aos[size_t(i)];
+            s.unit[0] = dx / length;
+            s.unit[1] = dy / length;
+            s.unit[2] = dz / length;
+            s.length = length;
+            s.cruise = (1200.0 + (i % 9) * 300.0) / 60.0;
+            s.accel = HUGE_VAL;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const double component = std::fabs(s.unit[axis]);
+                if (component > 0.0)
+                {
+                    s.cruise = std::min(s.cruise, limits.maxVelocity[axis] / component);
+                    s.accel = std::min(s.accel, limits.maxAcceleration[axis] / component);
+                }
+            }
+            px = x;
+            py = y;
+            pz = z;
+        }
+    }
+
+    runner.run("planner", "AoS reference, 1024 segments", [&]()
+               { return int(planAos(aos, 0.013) * 1000.0); });
+
+    planner.setProfile(MotionPlanner::Trapezoidal);
+    runner.run("planner", "MotionPlanner trapezoidal, 1024 seg", [&]()
+               {
+        planner.plan();
+        return int(planner.totalTime() * 1000.0); });
+
+    planner.setProfile(MotionPlanner::SCurve);
+    runner.run("planner", "MotionPlanner S-curve, 1024 seg", [&]()
+               {
+        planner.plan();
+        return int(planner.totalTime() * 1000.0); });
+
+    runner.run("planner", "fill + plan, 1024 seg", [&]()
+               {
+        fillPlanner(planner);
+        planner.plan();
+        return planner.segmentCount(); });
+}
@@ -0,0 +1,57 @@
+// PositionEstimatorBench.cpp
+#include "BenchHarness.h"
+#include "PositionEstimator.h"
+#include "TinybeeController.h"
+#include <cmath>
+
+namespace
+{
+constexpr int QueuedMoves = 32;
+constexpr qint64 StartNs = 1000000000;
+
+// A window of short moves along a curve, as streamed from a CAM program
+void fillEstimator(PositionEstimator &estimator)
+{
+    for (int i = 0; i < QueuedMoves; ++i)
+    {
+        const double t = (i + 1) * 0.2;
+        const QByteArray line = "G1 X" + QByteArray::number(t * 10.0, 'f', 3) + " Y" +
+                                QByteArray::number(5.0 * std::sin(t), 'f', 3) + " F6000";
+        estimator.queueLine(quint64(i + 1), line, StartNs);
+    }
+}
+} // namespace
+
+// The per-frame and per-report cost the UI pays to show a continuous
+// position instead of polling for one
+void runPositionEstimatorBenchmarks(BenchRunner &runner)
+{
+    PositionEstimator estimator;
+    fillEstimator(estimator);
+
+    // Sweeps the first half of the path, where the moves are still queued
+    qint64 step = 0;
+    runner.run("estimator", "estimate(), 32 moves queued", [&]()
+               {
+        step = (step + 1) % 1000;
+        const PositionEstimate e = estimator.estimate(StartNs + step * 100000);
+        return int(e.pos[0]); });
+
+    runner.run("estimator", "queue 32 moves + first estimate", [&]()
+               {
+        PositionEstimator fresh;
+        fillEstimator(fresh);
+        return int(fresh.estimate(StartNs + 50000000).pos[0]); });
+
+    // A report on the path, slightly behind the estimate: re-anchors the timeline
+    MotorPosition report;
+    report.timestampNs = StartNs + 50000000;
+    const PositionEstimate at = estimator.estimate(report.timestampNs - 2000000);
+    report.x = at.pos[0];
+    report.y = at.pos[1];
+    report.z = at.pos[2];
+    runner.run("estimator", "applyReport() on path", [&]()
+               {
+        estimator.applyReport(report);
+        return estimator.pendingSegments(); });
+}
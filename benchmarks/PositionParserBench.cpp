@@ -0,0 +1,94 @@
+// PositionParserBench.cpp
+#include "BenchHarness.h"
+#include "PositionParser.h"
+#include "TinybeeController.h"
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace
+{
+// MotorControlWidget::handleSerialRead() before PositionParser: a new regex per line
+bool legacyRegexParse(const QString &line, MotorPosition &pos)
+{
+    if (!(line.contains("X:") && line.contains("Y:") && line.contains("Z:")))
+        return false;
+    QRegularExpression rx(R"(X:([-+]?\d*\.?\d+)\s+Y:([-+]?\d*\.?\d+)\s+Z:([-+]?\d*\.?\d+))");
+    QRegularExpressionMatch match = rx.match(line);
+    if (!match.hasMatch())
+        return false;
+    pos.x = match.captured(1).toDouble();
+    pos.y = match.captured(2).toDouble();
+    pos.z = match.captured(3).toDouble();
+    return true;
+}
+
+// TinyBeeController::parseResponse() + getPosition() before PositionParser
+bool legacyHashParse(const QString &response, MotorPosition &pos)
+{
+    QHash<QString, QString> parsed;
+    const QStringList parts = response.trimmed().split(' ', Qt::SkipEmptyParts);
+    for (const QString &part : parts)
+    {
+        int colonIndex = part.indexOf(':');
+        if (colonIndex > 0 && colonIndex < part.length() - 1)
+            parsed.insert(part.left(colonIndex), part.mid(colonIndex + 1));
+    }
+
+    bool okX, okY, okZ;
+    double x = parsed.value("X").toDouble(&okX);
+    double y = parsed.value("Y").toDouble(&okY);
+    double z = parsed.value("Z").toDouble(&okZ);
+    if (!okX || !okY || !okZ)
+        return false;
+    pos.x = x;
+    pos.y = y;
+    pos.z = z;
+    return true;
+}
+
+QVector<QByteArray> makeReports(int count)
+{
+    QVector<QByteArray> reports;
+    reports.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        double x = (i % 300) * 0.37, y = 120.0 - (i % 170) * 0.61, z = (i % 50) * 0.2;
+        reports.append(QString("X:%1 Y:%2 Z:%3 E:0.00 Count X:%4 Y:%5 Z:%6")
+                           .arg(x, 0, 'f', 2)
+                           .arg(y, 0, 'f', 2)
+                           .arg(z, 0, 'f', 2)
+                           .arg(qRound(x * 80))
+                           .arg(qRound(y * 80))
+                           .arg(qRound(z * 400))
+                           .toUtf8());
+    }
+    return reports;
+}
+} // namespace
+
+void runPositionParserBenchmarks(BenchRunner &runner)
+{
+    const QVector<QByteArray> reports = makeReports(1024);
+    int index = 0;
+    MotorPosition pos;
+
+    // The legacy paths start from received bytes too, so the UTF-8 decode is part of their cost
+    runner.run("m114", "legacy QRegularExpression per line", [&]()
+               {
+        const QByteArray &line = reports[index++ & 1023];
+        legacyRegexParse(QString::fromUtf8(line), pos);
+        return pos.x > 0; });
+
+    runner.run("m114", "legacy split + QHash + toDouble", [&]()
+               {
+        const QByteArray &line = reports[index++ & 1023];
+        legacyHashParse(QString::fromUtf8(line), pos);
+        return pos.y > 0; });
+
+    runner.run("m114", "parsePositionReport", [&]()
+               {
+        const QByteArray &line = reports[index++ & 1023];
+        parsePositionReport(std::string_view(line.constData(), size_t(line.size())), pos);
+        return pos.countX; });
+}
@@ -0,0 +1,43 @@
+// ResponseParserBench.cpp
+#include "BenchHarness.h"
+#include "PositionParser.h"
+#include "TinybeeController.h"
+#include <QHash>
+
+namespace
+{
+const char *const Responses[] = {
+    "X:10.00 Y:15.00 Z:5.00 E:0.00 Count X:800 Y:1200 Z:2000",
+    "X:-3.25 Y:120.75 Z:0.40 E:0.00 Count X:-260 Y:9660 Z:160",
+    "FIRMWARE_NAME:Marlin 2.1.2 SOURCE_CODE_URL:github.com/MarlinFirmware/Marlin PROTOCOL_VERSION:1.0",
+    "T:25.00 /0.00 B:25.00 /0.00 @:0 B@:0",
+};
+constexpr int ResponseCount = int(sizeof(Responses) / sizeof(Responses[0]));
+} // namespace
+
+void runResponseParserBenchmarks(BenchRunner &runner)
+{
+    QVector<QString> responses;
+    QVector<QByteArray> raw;
+    for (const char *response : Responses)
+    {
+        responses.append(QString::fromLatin1(response));
+        raw.append(QByteArray(response));
+    }
+    int index = 0;
+
+    // Generic key:value split used by callers of TinyBeeController::parseResponse()
+    TinyBeeController controller;
+    QHash<QString, QString> parsed;
+    runner.run("response", "TinyBeeController::parseResponse", [&]()
+               {
+        controller.parseResponse(responses[index++ % ResponseCount], parsed);
+        return parsed.size(); });
+
+    // Position replies through the single-pass scanner used on the RX path
+    MotorPosition pos;
+    runner.run("response", "parsePositionReport (mixed replies)", [&]()
+               {
+        const QByteArray &line = raw[index++ % ResponseCount];
+        return int(parsePositionReport(std::string_view(line.constData(), size_t(line.size())), pos)); });
+}
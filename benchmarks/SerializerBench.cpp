@@ -0,0 +1,71 @@
+// SerializerBench.cpp
+#include "BenchHarness.h"
+#include "GCodeSerializer.h"
+#include "TinybeeController.h"
+#include <QVector>
+
+namespace
+{
+// TinyBeeController::buildCommandString() before GCodeSerializer, kept as the baseline
+QString legacyBuildCommandString(const GCodeCommand &cmd)
+{
+    switch (cmd.type)
+    {
+    case GCodeCommandType::Move:
+        return QString("G1 X%1 Y%2 Z%3 F%4\n")
+            .arg(cmd.x, 0, 'f', 3)
+            .arg(cmd.y, 0, 'f', 3)
+            .arg(cmd.z, 0, 'f', 3)
+            .arg(cmd.feedrate);
+    case GCodeCommandType::Custom:
+        return cmd.customCommand.trimmed() + "\n";
+    default:
+        return QString();
+    }
+}
+
+QVector<GCodeCommand> makeToolpath(int count)
+{
+    // Short segments along a spiral, similar to a dense CAM toolpath
+    QVector<GCodeCommand> moves;
+    moves.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        GCodeCommand cmd;
+        cmd.type = GCodeCommandType::Move;
+        double t = i * 0.01;
+        cmd.x = 50.0 + t * 3.1 * ((i % 7) - 3);
+        cmd.y = -20.0 + t * 1.7 * ((i % 5) - 2);
+        cmd.z = 0.2 * (i % 40);
+        cmd.feedrate = 1200 + (i % 9) * 100;
+        moves.append(cmd);
+    }
+    return moves;
+}
+} // namespace
+
+void runSerializerBenchmarks(BenchRunner &runner)
+{
+    const QVector<GCodeCommand> moves = makeToolpath(4096);
+    int index = 0;
+
+    runner.run("serializer", "legacy QString::arg + toUtf8", [&]()
+               {
+        const GCodeCommand &cmd = moves[index++ & 4095];
+        QByteArray data = legacyBuildCommandString(cmd).toUtf8();
+        return data.size(); });
+
+    GCodeSerializer serializer;
+    runner.run("serializer", "GCodeSerializer::serialize", [&]()
+               {
+        const GCodeCommand &cmd = moves[index++ & 4095];
+        serializer.serialize(cmd);
+        return serializer.size(); });
+
+    runner.run("serializer", "GCodeSerializer + QByteArray copy", [&]()
+               {
+        const GCodeCommand &cmd = moves[index++ & 4095];
+        serializer.serialize(cmd);
+        QByteArray data = serializer.toByteArray();
+        return data.size(); });
+}
@@ -0,0 +1,71 @@
+// SessionReplayBench.cpp
+#include "BenchHarness.h"
+#include "SerialSession.h"
+#include "TinybeeController.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QTimer>
+
+namespace
+{
+constexpr int Exchanges = 20000;
+
+// Polling traffic as a Marlin board produces it: M114 out, report and ok back
+QString writeSession()
+{
+    const QString path = QDir::tempPath() + QString("/controlmotor-bench-%1.tbsession").arg(QCoreApplication::applicationPid());
+    SerialSessionWriter writer;
+    if (!writer.open(path))
+        return QString();
+
+    const QByteArray query = "M114\n";
+    for (int i = 0; i < Exchanges; ++i)
+    {
+        const QByteArray report = QString("X:%1 Y:2.00 Z:3.00 E:0.00 Count X:%2 Y:200 Z:300\nok\n")
+                                      .arg(double(i % 100), 0, 'f', 2)
+                                      .arg(i % 100 * 80)
+                                      .toLatin1();
+        writer.record(SerialSessionRecord::Tx, query.constData(), query.size());
+        writer.record(SerialSessionRecord::Rx, report.constData(), report.size());
+    }
+    writer.close();
+    return path;
+}
+} // namespace
+
+void runSessionReplayBenchmarks(BenchRunner &runner)
+{
+    const QString name = QString("unpaced, %1 M114 exchanges").arg(Exchanges);
+    if (!QCoreApplication::instance() || !runner.selected("replay", name))
+        return;
+
+    const QString path = writeSession();
+    if (path.isEmpty())
+    {
+        std::printf("replay         skipped: could not write a session file\n");
+        return;
+    }
+
+    // Everything received goes through framing, parsing and the event ring
+    TinyBeeController controller;
+    qint64 reports = 0;
+    QObject::connect(&controller, &TinyBeeController::positionUpdated, [&reports](const MotorPosition &)
+                     { ++reports; });
+
+    QEventLoop loop;
+    QObject::connect(&controller, &TinyBeeController::replayFinished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+
+    QElapsedTimer clock;
+    clock.start();
+    if (controller.connectReplay(path, 0.0))
+    {
+        loop.exec();
+        runner.report("replay", name, reports, double(clock.nsecsElapsed()));
+        controller.disconnectPort();
+    }
+    QFile::remove(path);
+}
@@ -1,14 +1,29 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include "ControlServer.h"
 #include "MotorControlWidget.h"
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption serveOption("serve", "Accept commands from other processes on this local socket.", "name");
+    parser.addOption(serveOption);
+    parser.process(app);
+
     // Create the motor control widget
     MotorControlWidget *motorControl = new MotorControlWidget();
     motorControl->resize(800, 600);
     motorControl->show();
 
+    // External processes share the board the widget connects to
+    if (parser.isSet(serveOption))
+    {
+        ControlServer *server = new ControlServer(motorControl->motorController(), motorControl);
+        server->listen(parser.value(serveOption));
+    }
+
     return app.exec();
 }
@@ -0,0 +1,307 @@
+// JobRunner.cpp
+#include "JobRunner.h"
+#include "ControlServer.h"
+#include "GCodeFileStreamer.h"
+#include "LinkStatistics.h"
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace
+{
+constexpr int StdinReadSize = 64 * 1024;
+
+QByteArray formatMs(quint64 us)
+{
+    return QByteArray::number(double(us) / 1000.0, 'f', 2) + " ms";
+}
+} // namespace
+
+JobRunner::JobRunner(const RunnerConfig &config, QObject *parent)
+    : QObject(parent), m_config(config)
+{
+    // Overwriting one status line only makes sense on a terminal; under
+    // systemd each progress report becomes its own journal line
+    m_progressOnTty = isatty(STDERR_FILENO);
+    m_progressTimer.setInterval(qMax(1, m_config.progressIntervalMs));
+    connect(&m_progressTimer, &QTimer::timeout, this, &JobRunner::printProgress);
+
+    connect(&m_controller, &TinyBeeController::commandCompleted, this, &JobRunner::onCommandCompleted);
+    connect(&m_controller, &TinyBeeController::commandFailed, this, &JobRunner::onCommandFailed);
+}
+
+JobRunner::~JobRunner()
+{
+    if (m_controller.isConnected())
+        m_controller.disconnectPort();
+}
+
+void JobRunner::start(const QString &path)
+{
+    m_path = path;
+    m_controller.setStreamingMode(m_config.mode);
+    m_controller.setWindowSize(m_config.windowSize);
+    m_controller.setRxBufferSize(m_config.rxBufferSize);
+    m_controller.setLineNumbering(m_config.lineNumbering);
+
+    if (!m_controller.connectPort(m_config.portName, m_config.baudRate))
+    {
+        std::fprintf(stderr, "Failed to open %s\n", qPrintable(m_config.portName));
+        m_done = true;
+        emit finished(ConnectFailed);
+        return;
+    }
+
+    if (!m_config.serverName.isEmpty())
+    {
+        m_server = new ControlServer(&m_controller, this);
+        QString error;
+        if (!m_server->listen(m_config.serverName, &error))
+        {
+            std::fprintf(stderr, "Failed to listen on %s: %s\n", qPrintable(m_config.serverName), qPrintable(error));
+            m_done = true;
+            m_controller.disconnectPort();
+            emit finished(ConnectFailed);
+            return;
+        }
+    }
+
+    QTimer::singleShot(m_config.startupDelayMs, this, &JobRunner::beginJob);
+}
+
+void JobRunner::beginJob()
+{
+    if (m_done)
+        return;
+
+    // Rates and latencies cover the job only, not the startup delay
+    m_controller.resetLinkStatistics();
+    // Clients following the position stream need reports to flow. Not before
+    // the startup delay: a board that resets on connect would answer the
+    // M115/M114 probes from its bootloader, if at all.
+    if (m_server)
+        m_controller.startPositionUpdates();
+    if (m_config.progressIntervalMs > 0)
+        m_progressTimer.start();
+
+    if (m_path.isEmpty() && m_server)
+    {
+        m_serveOnly = true;
+        return;
+    }
+
+    if (m_path.isEmpty() || m_path == "-")
+    {
+        m_stdinNotifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+        connect(m_stdinNotifier, &QSocketNotifier::activated, this, &JobRunner::readStdin);
+        return;
+    }
+
+    m_streamer = new GCodeFileStreamer(&m_controller, this);
+    m_streamer->setMaxQueued(MaxQueued);
+    m_streamer->setLineTimeout(m_config.lineTimeoutMs);
+    connect(m_streamer, &GCodeFileStreamer::started, this, [this](qint64 totalBytes)
+            { m_totalBytes = totalBytes; });
+    connect(m_streamer, &GCodeFileStreamer::finished, this, [this]()
+            { finish(Success); });
+    connect(m_streamer, &GCodeFileStreamer::failed, this, [this](const QString &error)
+            {
+        if (m_streamer->linesSent() > 0)
+            ++m_linesFailed;
+        fail(error); });
+    m_streamer->start(m_path);
+}
+
+void JobRunner::interrupt(int signal)
+{
+    if (m_done)
+        return;
+    std::fprintf(stderr, "%sInterrupted by signal %d, cancelling queued lines\n",
+                 m_progressOnTty && m_progressTimer.isActive() ? "\n" : "", signal);
+    finish(128 + signal);
+}
+
+void JobRunner::readStdin()
+{
+    char buffer[StdinReadSize];
+    const ssize_t n = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (n < 0)
+    {
+        if (errno != EAGAIN && errno != EINTR)
+            fail(QString("Failed to read stdin: %1").arg(QString::fromLocal8Bit(std::strerror(errno))));
+        return;
+    }
+
+    if (n == 0)
+    {
+        m_stdinDone = true;
+        m_stdinNotifier->setEnabled(false);
+        takeStdinLines(true);
+    }
+    else
+    {
+        m_stdinBuffer.append(buffer, int(n));
+        takeStdinLines(false);
+    }
+    feedStdin();
+}
+
+void JobRunner::takeStdinLines(bool atEnd)
+{
+    const char *data = m_stdinBuffer.constData();
+    const char *end = data + m_stdinBuffer.size();
+    const char *begin = data;
+    QByteArray line;
+    while (begin < end)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(begin, '\n', size_t(end - begin)));
+        if (!newline && !atEnd)
+            break; // Rest of the line comes with the next read
+        const char *lineEnd = newline ? newline : end;
+        if (GCodeLineTokenizer::clean(begin, lineEnd, line))
+            m_stdinLines.enqueue(line);
+        begin = newline ? newline + 1 : end;
+    }
+    m_stdinBuffer.remove(0, int(begin - data));
+}
+
+void JobRunner::feedStdin()
+{
+    while (!m_done && m_outstanding.size() < MaxQueued && !m_stdinLines.isEmpty())
+    {
+        const quint64 id = m_controller.enqueueLine(m_stdinLines.head(), m_config.lineTimeoutMs);
+        if (id == 0)
+        {
+            fail(QString("Controller rejected line: %1").arg(QString::fromUtf8(m_stdinLines.head())));
+            return;
+        }
+        m_stdinLines.dequeue();
+        m_outstanding.insert(id);
+    }
+
+    if (m_done)
+        return;
+    if (m_stdinDone)
+    {
+        if (m_stdinLines.isEmpty() && m_outstanding.isEmpty())
+            finish(Success);
+        return;
+    }
+    // Read more only once the board has caught up with what is buffered
+    m_stdinNotifier->setEnabled(m_stdinLines.size() < MaxQueued);
+}
+
+void JobRunner::onCommandCompleted(quint64 id)
+{
+    // Only stdin lines are tracked here; GCodeFileStreamer and ControlServer
+    // follow their own
+    if (m_outstanding.remove(id))
+    {
+        ++m_linesCompleted;
+        feedStdin();
+    }
+}
+
+void JobRunner::onCommandFailed(quint64 id, const QString &error)
+{
+    if (m_done)
+        return;
+    if (m_outstanding.remove(id))
+    {
+        ++m_linesFailed;
+        fail(QString("Line failed: %1").arg(error));
+    }
+}
+
+qint64 JobRunner::linesCompleted() const
+{
+    if (m_serveOnly)
+        return qint64(m_controller.linkStatistics().commandCount());
+    return m_streamer ? m_streamer->linesCompleted() : m_linesCompleted;
+}
+
+void JobRunner::printProgress()
+{
+    const LinkStatistics stats = m_controller.linkStatistics();
+    char text[128];
+    if (m_serveOnly)
+    {
+        std::snprintf(text, sizeof(text), "%d clients  %llu commands  %.0f commands/s", m_server->clientCount(),
+                      static_cast<unsigned long long>(stats.commandCount()), stats.commandsPerSecond());
+    }
+    else if (m_streamer && m_totalBytes > 0)
+    {
+        std::snprintf(text, sizeof(text), "%5.1f%%  %lld lines  %.0f lines/s",
+                      100.0 * double(m_streamer->bytesProcessed()) / double(m_totalBytes),
+                      static_cast<long long>(linesCompleted()), stats.commandsPerSecond());
+    }
+    else
+    {
+        std::snprintf(text, sizeof(text), "%lld lines  %.0f lines/s",
+                      static_cast<long long>(linesCompleted()), stats.commandsPerSecond());
+    }
+
+    if (m_progressOnTty)
+        std::fprintf(stderr, "\r%-60s", text);
+    else
+        std::fprintf(stderr, "%s\n", text);
+    std::fflush(stderr);
+}
+
+void JobRunner::fail(const QString &error)
+{
+    if (m_done)
+        return;
+    std::fprintf(stderr, "%s%s\n", m_progressOnTty && m_progressTimer.isActive() ? "\n" : "", qPrintable(error));
+    finish(JobFailed);
+}
+
+void JobRunner::finish(int exitCode)
+{
+    if (m_done)
+        return;
+    m_done = true;
+
+    if (m_progressTimer.isActive())
+    {
+        m_progressTimer.stop();
+        printProgress();
+        if (m_progressOnTty)
+            std::fputc('\n', stderr);
+    }
+    if (m_stdinNotifier)
+        m_stdinNotifier->setEnabled(false);
+    if (m_streamer)
+        m_streamer->stop();
+    m_controller.clearQueue();
+    if (m_server)
+        m_server->close();
+
+    printSummary();
+    m_controller.disconnectPort();
+    emit finished(exitCode);
+}
+
+void JobRunner::printSummary()
+{
+    const LinkStatistics stats = m_controller.linkStatistics();
+    const LinkStatistics::KindStats all = stats.combined();
+    const LatencyHistogram &rtt = all.roundTrip;
+
+    std::printf("%lld lines ok, %lld failed in %.2f s\n", static_cast<long long>(linesCompleted()),
+                static_cast<long long>(m_linesFailed), stats.elapsedSeconds());
+    std::printf("  lines/s   %.1f\n", stats.commandsPerSecond());
+    std::printf("  bytes/s   %.0f tx, %.0f rx\n", stats.bytesWrittenPerSecond(), stats.bytesReceivedPerSecond());
+    std::printf("  ack rtt   p50 %s  p90 %s  p99 %s  max %s\n", formatMs(rtt.percentile(50)).constData(),
+                formatMs(rtt.percentile(90)).constData(), formatMs(rtt.percentile(99)).constData(),
+                formatMs(rtt.max()).constData());
+    if (stats.resendRequests > 0)
+        std::printf("  resends   %llu requested, %llu lines resent\n",
+                    static_cast<unsigned long long>(stats.resendRequests),
+                    static_cast<unsigned long long>(stats.linesResent));
+    if (m_config.verbose)
+        std::printf("%s\n", qPrintable(stats.toText()));
+    std::fflush(stdout);
+}
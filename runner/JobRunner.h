@@ -0,0 +1,103 @@
+// JobRunner.h
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QQueue>
+#include <QSet>
+#include <QTimer>
+#include "TinybeeController.h"
+
+class ControlServer;
+class GCodeFileStreamer;
+class QSocketNotifier;
+
+struct RunnerConfig
+{
+    QString portName;
+    qint32 baudRate = 115200;
+    StreamingMode mode = StreamingMode::SendAndWait;
+    int windowSize = 4;
+    int rxBufferSize = 127;
+    bool lineNumbering = false;    // Marlin N/checksum framing with resends
+    int startupDelayMs = 0;        // Boards that reset on connect need ~2000
+    int lineTimeoutMs = 10000;     // Ack timeout; well above Marlin's 2 s busy: keepalive
+    int progressIntervalMs = 1000; // 0 = no progress output
+    bool verbose = false;          // Full per-kind statistics in the summary
+    QString serverName;            // ControlServer socket; empty = none
+};
+
+// Streams one G-code job (a file, or stdin when the path is empty or "-")
+// through TinyBeeController without any GUI. Progress goes to stderr, the
+// closing throughput/latency summary to stdout. Files are memory-mapped by
+// GCodeFileStreamer; stdin is read as it becomes readable and cleaned with
+// GCodeLineTokenizer, and reading pauses while MaxQueued lines are waiting,
+// so a pipe is never drained faster than the board consumes it.
+//
+// With a server name, other processes can submit lines and follow positions
+// through a ControlServer alongside the job. Without a job (start() with an
+// empty path) the runner then only serves, until it is interrupted.
+class JobRunner : public QObject
+{
+    Q_OBJECT
+public:
+    enum ExitCode
+    {
+        Success = 0,
+        ConnectFailed = 1,
+        JobFailed = 2
+    };
+
+    static constexpr int MaxQueued = 32; // Lines handed to the controller at a time
+
+    explicit JobRunner(const RunnerConfig &config, QObject *parent = nullptr);
+    ~JobRunner();
+
+    // Connects and starts streaming; finished() follows in all cases.
+    // "-" reads stdin; an empty path reads stdin unless a server is configured.
+    void start(const QString &path);
+    // Stops feeding, cancels queued lines and exits with 128 + signal
+    void interrupt(int signal);
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void beginJob();
+    void readStdin();
+    void onCommandCompleted(quint64 id);
+    void onCommandFailed(quint64 id, const QString &error);
+    void printProgress();
+
+private:
+    RunnerConfig m_config;
+    TinyBeeController m_controller;
+    GCodeFileStreamer *m_streamer = nullptr;
+    ControlServer *m_server = nullptr;
+    bool m_serveOnly = false;
+    QTimer m_progressTimer;
+    QString m_path;
+    bool m_done = false;
+    bool m_progressOnTty = false;
+    qint64 m_totalBytes = 0;
+
+    // stdin input
+    QSocketNotifier *m_stdinNotifier = nullptr;
+    QByteArray m_stdinBuffer; // Unterminated tail of the last read
+    QQueue<QByteArray> m_stdinLines;
+    QSet<quint64> m_outstanding;
+    bool m_stdinDone = false;
+
+    qint64 m_linesCompleted = 0;
+    qint64 m_linesFailed = 0;
+
+    qint64 linesCompleted() const;
+    void takeStdinLines(bool atEnd);
+    void feedStdin();
+    void fail(const QString &error);
+    void finish(int exitCode);
+    void printSummary();
+};
+
+#endif // JOBRUNNER_H
@@ -0,0 +1,99 @@
+// RunnerMain.cpp
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <csignal>
+#include <cstdio>
+#include <unistd.h>
+#include "JobRunner.h"
+
+namespace
+{
+int signalPipe[2] = {-1, -1};
+
+// Only async-signal-safe work here; the event loop picks the signal up
+void onSignal(int signal)
+{
+    const char byte = char(signal);
+    if (::write(signalPipe[1], &byte, 1) < 0)
+        return;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("TinyBeeRun");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Streams a G-code job to a TinyBee/Marlin board without a GUI");
+    parser.addHelpOption();
+    parser.addPositionalArgument("port", "Serial device, e.g. /dev/ttyUSB0.");
+    parser.addPositionalArgument("file", "G-code file; \"-\" (or omitted without --serve) reads stdin.", "[file]");
+    QCommandLineOption baudOption({"b", "baud"}, "Baud rate (default 115200).", "rate", "115200");
+    QCommandLineOption windowOption({"w", "window"}, "Keep this many lines in flight (Marlin BUFSIZE) instead of one.", "lines");
+    QCommandLineOption rxBufferOption("rx-buffer", "Character-counting mode with this receive buffer size (GRBL).", "bytes");
+    QCommandLineOption checksumOption("checksum", "Send lines with Marlin line numbers and checksums; resend what the firmware rejects.");
+    QCommandLineOption delayOption("startup-delay", "Wait after opening the port, for boards that reset on connect (default 0).", "ms", "0");
+    QCommandLineOption timeoutOption("line-timeout", "Fail a line not acknowledged within this time; keep it above the firmware's busy: interval (default 10000).", "ms", "10000");
+    QCommandLineOption progressOption("progress", "Progress report interval on stderr, 0 = off (default 1000).", "ms", "1000");
+    QCommandLineOption serveOption("serve", "Accept commands from other processes on this local socket; without a file, only serve.", "name");
+    QCommandLineOption verboseOption("verbose", "Print latency percentiles per command kind at exit.");
+    parser.addOption(baudOption);
+    parser.addOption(windowOption);
+    parser.addOption(rxBufferOption);
+    parser.addOption(checksumOption);
+    parser.addOption(delayOption);
+    parser.addOption(timeoutOption);
+    parser.addOption(progressOption);
+    parser.addOption(serveOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty() || args.size() > 2)
+        parser.showHelp(1);
+
+    RunnerConfig config;
+    config.portName = args.at(0);
+    config.baudRate = parser.value(baudOption).toInt();
+    if (parser.isSet(windowOption))
+    {
+        config.mode = StreamingMode::Windowed;
+        config.windowSize = parser.value(windowOption).toInt();
+    }
+    if (parser.isSet(rxBufferOption))
+    {
+        config.mode = StreamingMode::CharacterCounting;
+        config.rxBufferSize = parser.value(rxBufferOption).toInt();
+    }
+    config.lineNumbering = parser.isSet(checksumOption);
+    config.startupDelayMs = parser.value(delayOption).toInt();
+    config.lineTimeoutMs = qMax(1, parser.value(timeoutOption).toInt());
+    config.progressIntervalMs = parser.value(progressOption).toInt();
+    config.verbose = parser.isSet(verboseOption);
+    config.serverName = parser.value(serveOption);
+
+    JobRunner runner(config);
+    QObject::connect(&runner, &JobRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+
+    // SIGTERM is how systemd stops the unit; queued lines are cancelled and
+    // the summary is still printed
+    if (::pipe(signalPipe) == 0)
+    {
+        QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, &app);
+        QObject::connect(notifier, &QSocketNotifier::activated, &runner, [&runner]()
+                         {
+            char byte = 0;
+            if (::read(signalPipe[0], &byte, 1) == 1)
+                runner.interrupt(int(byte)); });
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+    }
+
+    const QString path = args.size() > 1 ? args.at(1) : QString();
+    QTimer::singleShot(0, &runner, [&runner, path]()
+                       { runner.start(path); });
+    return app.exec();
+}
@@ -0,0 +1,553 @@
+// FirmwareSimulator.cpp
+#include "FirmwareSimulator.h"
+#include <QSocketNotifier>
+#include <QDebug>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+// Value of the word starting with letter ("X12.5" -> 12.5), if present
+bool wordValue(const QList<QByteArray> &words, char letter, double &value)
+{
+    for (const QByteArray &word : words)
+    {
+        if (word.size() > 1 && word[0] == letter)
+        {
+            bool ok = false;
+            const double v = word.mid(1).toDouble(&ok);
+            if (ok)
+            {
+                value = v;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool hasWord(const QList<QByteArray> &words, char letter)
+{
+    for (const QByteArray &word : words)
+    {
+        if (!word.isEmpty() && word[0] == letter)
+            return true;
+    }
+    return false;
+}
+} // namespace
+
+FirmwareSimulator::FirmwareSimulator(const SimulatorConfig &config, QObject *parent)
+    : QObject(parent), m_config(config)
+{
+    m_config.plannerDepth = qMax(1, m_config.plannerDepth);
+    // 1 would reject every resent copy as well
+    m_config.corruptEvery = m_config.corruptEvery > 0 ? qMax(2, m_config.corruptEvery) : 0;
+    m_clock.start();
+    m_tickTimer.setInterval(5);
+    connect(&m_tickTimer, &QTimer::timeout, this, &FirmwareSimulator::tick);
+}
+
+FirmwareSimulator::~FirmwareSimulator()
+{
+    close();
+}
+
+bool FirmwareSimulator::open(QString *error)
+{
+    close();
+
+    m_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (m_master < 0 || grantpt(m_master) != 0 || unlockpt(m_master) != 0)
+    {
+        if (error)
+            *error = QString("Failed to create pseudo-terminal: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        close();
+        return false;
+    }
+
+    m_portName = QString::fromLocal8Bit(ptsname(m_master));
+    m_slave = ::open(ptsname(m_master), O_RDWR | O_NOCTTY);
+    if (m_slave < 0)
+    {
+        if (error)
+            *error = QString("Failed to open %1: %2").arg(m_portName, QString::fromLocal8Bit(std::strerror(errno)));
+        close();
+        return false;
+    }
+
+    // Raw bytes in both directions, like a USB CDC device
+    termios tio;
+    if (tcgetattr(m_slave, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(m_slave, TCSANOW, &tio);
+    }
+    ::fcntl(m_master, F_SETFL, ::fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+    m_notifier = new QSocketNotifier(m_master, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &FirmwareSimulator::onReadable);
+
+    m_lastBusyMs = m_clock.elapsed();
+    send("start\necho:TinyBee simulator\n");
+    return true;
+}
+
+void FirmwareSimulator::close()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    m_tickTimer.stop();
+    if (m_slave >= 0)
+        ::close(m_slave);
+    if (m_master >= 0)
+        ::close(m_master);
+    m_slave = -1;
+    m_master = -1;
+    m_rx.clear();
+    m_pendingLines.clear();
+    m_blocks.clear();
+    m_lastLineNumber = 0;
+}
+
+void FirmwareSimulator::onReadable()
+{
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(m_master, buffer, sizeof(buffer))) > 0)
+        m_rx.append(buffer, int(n));
+
+    int start = 0;
+    int newline;
+    while ((newline = m_rx.indexOf('\n', start)) >= 0)
+    {
+        QByteArray line = m_rx.mid(start, newline - start).trimmed();
+        start = newline + 1;
+        if (line.isEmpty())
+            continue;
+        ++m_linesReceived;
+        emit commandReceived(line);
+        if (!acceptLine(line))
+        {
+            // Marlin flushes its RX buffer with the resend request, so lines
+            // already received behind a rejected one are dropped unanswered.
+            // A partial line is kept: the rest of it would otherwise arrive
+            // as a stray command. The emergency parser has already seen the
+            // dropped bytes, so a stop among them still acts.
+            const int lastNewline = m_rx.lastIndexOf('\n');
+            while (start <= lastNewline)
+            {
+                const int next = m_rx.indexOf('\n', start);
+                const QByteArray dropped = m_rx.mid(start, next - start).trimmed();
+                start = next + 1;
+                if (isEmergencyCommand(dropped))
+                {
+                    ++m_linesReceived;
+                    emit commandReceived(dropped);
+                    emergencyStop(dropped.toUpper() == "M112");
+                }
+            }
+            continue;
+        }
+
+        // Emergency parser: these act on arrival, ahead of anything queued
+        if (isEmergencyCommand(line))
+        {
+            emergencyStop(line.toUpper() == "M112");
+            continue;
+        }
+        m_pendingLines.enqueue(line);
+    }
+    m_rx.remove(0, start);
+
+    processPending();
+}
+
+bool FirmwareSimulator::isEmergencyCommand(const QByteArray &line)
+{
+    const QByteArray upper = line.toUpper();
+    return upper == "M112" || upper == "M410";
+}
+
+bool FirmwareSimulator::acceptLine(QByteArray &line)
+{
+    const int star = line.lastIndexOf('*');
+    if (line[0] != 'N')
+        return star < 0 || requestResend("No Line Number with checksum");
+
+    int end = 1;
+    while (end < line.size() && line[end] >= '0' && line[end] <= '9')
+        ++end;
+    const qint64 number = line.mid(1, end - 1).toLongLong();
+    const QByteArray command = line.mid(end, (star < 0 ? line.size() : star) - end).trimmed();
+    const bool setsLineNumber = command.toUpper().startsWith("M110");
+
+    // Same order of checks as Marlin's gcode_line_error()
+    if (number != m_lastLineNumber + 1 && !setsLineNumber)
+        return requestResend("Line Number is not Last Line Number+1");
+    if (star < 0)
+        return requestResend("No Checksum with line number");
+
+    quint8 checksum = 0;
+    for (int i = 0; i < star; ++i)
+        checksum ^= quint8(line[i]);
+    bool ok = false;
+    const int received = line.mid(star + 1).trimmed().toInt(&ok);
+    const bool corrupted = m_config.corruptEvery > 0 && (m_numberedLines + 1) % quint64(m_config.corruptEvery) == 0;
+    if (!ok || received != checksum || corrupted)
+    {
+        // A corrupted line is not counted, so the resent copy gets through
+        if (corrupted)
+            ++m_numberedLines;
+        return requestResend("checksum mismatch");
+    }
+
+    ++m_numberedLines;
+    m_lastLineNumber = number;
+    double n;
+    if (setsLineNumber && wordValue(command.toUpper().split(' '), 'N', n))
+        m_lastLineNumber = qint64(n);
+    line = command;
+    return true;
+}
+
+bool FirmwareSimulator::requestResend(const char *reason)
+{
+    ++m_resendsRequested;
+    send(QByteArray("Error:") + reason + ", Last Line: " + QByteArray::number(m_lastLineNumber) +
+         "\nResend: " + QByteArray::number(m_lastLineNumber + 1) + "\nok\n");
+    return false;
+}
+
+void FirmwareSimulator::processPending()
+{
+    // Commands run strictly in order; one that has to wait holds back the rest
+    while (!m_pendingLines.isEmpty() && execute(m_pendingLines.head()))
+    {
+        m_pendingLines.dequeue();
+        m_lastBusyMs = m_clock.elapsed();
+    }
+    updateTimer();
+}
+
+bool FirmwareSimulator::execute(const QByteArray &raw)
+{
+    QByteArray line = raw;
+    const int comment = line.indexOf(';');
+    if (comment >= 0)
+        line.truncate(comment);
+    line = line.trimmed().toUpper();
+    if (line.isEmpty())
+    {
+        send("ok\n");
+        return true;
+    }
+
+    const QList<QByteArray> words = line.split(' ');
+    const QByteArray &code = words.first();
+
+    if (code == "G0" || code == "G1")
+    {
+        if (m_blocks.size() >= m_config.plannerDepth)
+            return false;
+
+        double feed;
+        if (wordValue(words, 'F', feed) && feed > 0.0)
+            m_feedrate = feed;
+
+        double to[3] = {m_target[0], m_target[1], m_target[2]};
+        const char axes[3] = {'X', 'Y', 'Z'};
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            double v;
+            if (wordValue(words, axes[axis], v))
+                to[axis] = m_relative ? to[axis] + v : v;
+        }
+
+        double d[3], length2 = 0.0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            d[axis] = to[axis] - m_target[axis];
+            length2 += d[axis] * d[axis];
+        }
+        const double length = std::sqrt(length2);
+        if (length > 0.0)
+        {
+            qint64 durationMs = m_config.moveTimeMs;
+            if (durationMs < 0)
+            {
+                // Requested feedrate, capped by the slowest axis involved
+                double speed = m_feedrate / 60.0;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const double component = std::fabs(d[axis]) / length;
+                    if (component > 0.0)
+                        speed = qMin(speed, m_config.limits.maxVelocity[axis] / component);
+                }
+                durationMs = qMax<qint64>(1, qint64(length / speed * 1000.0));
+            }
+            queueMove(to, durationMs);
+        }
+        send("ok\n");
+        return true;
+    }
+
+    if (code == "G28")
+    {
+        // Homing waits for the planner to drain and replies once it is done
+        if (!m_blocks.isEmpty())
+            return false;
+        if (!m_homing)
+        {
+            const bool all = !hasWord(words, 'X') && !hasWord(words, 'Y') && !hasWord(words, 'Z');
+            double to[3] = {m_target[0], m_target[1], m_target[2]};
+            if (all || hasWord(words, 'X'))
+                to[0] = 0.0;
+            if (all || hasWord(words, 'Y'))
+                to[1] = 0.0;
+            if (all || hasWord(words, 'Z'))
+                to[2] = 0.0;
+            queueMove(to, m_config.homingTimeMs);
+            m_homing = true;
+            return false;
+        }
+        m_homing = false;
+        send(positionReport() + "ok\n");
+        return true;
+    }
+
+    if (code == "M400")
+    {
+        if (!m_blocks.isEmpty())
+            return false;
+        send("ok\n");
+        return true;
+    }
+
+    if (code == "G90" || code == "G91")
+    {
+        m_relative = code == "G91";
+        send("ok\n");
+        return true;
+    }
+
+    if (code == "G92")
+    {
+        if (!m_blocks.isEmpty())
+            return false;
+        const char axes[3] = {'X', 'Y', 'Z'};
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            double v;
+            if (wordValue(words, axes[axis], v))
+                m_position[axis] = m_target[axis] = v;
+        }
+        send("ok\n");
+        return true;
+    }
+
+    if (code == "M114")
+    {
+        send(positionReport() + "ok\n");
+        return true;
+    }
+
+    if (code == "M115")
+    {
+        send("FIRMWARE_NAME:Marlin 2.1.2 (TinyBee simulator) SOURCE_CODE_URL:github.com/MarlinFirmware/Marlin "
+             "PROTOCOL_VERSION:1.0 MACHINE_TYPE:TinyBee EXTRUDER_COUNT:1\n"
+             "Cap:SERIAL_XON_XOFF:0\n"
+             "Cap:EEPROM:0\n"
+             "Cap:AUTOREPORT_POS:1\n"
+             "Cap:BUSY_PROTOCOL:1\n"
+             "Cap:EMERGENCY_PARSER:1\n"
+             "ok\n");
+        return true;
+    }
+
+    if (code == "M154")
+    {
+        double seconds = 0.0;
+        wordValue(words, 'S', seconds);
+        m_autoReportMs = int(qMax(0.0, seconds) * 1000.0);
+        m_lastAutoReportMs = m_clock.elapsed();
+        send("ok\n");
+        return true;
+    }
+
+    if (code == "M203" || code == "M201")
+    {
+        double *values = code == "M203" ? m_config.limits.maxVelocity : m_config.limits.maxAcceleration;
+        const char axes[3] = {'X', 'Y', 'Z'};
+        bool changed = false;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            double v;
+            if (wordValue(words, axes[axis], v) && v > 0.0)
+            {
+                values[axis] = v;
+                changed = true;
+            }
+        }
+        if (!changed)
+        {
+            send(QByteArray(code == "M203" ? "echo:; Max feedrates (units/s):\n" : "echo:; Max Acceleration (units/s2):\n") +
+                 "echo:  " + code +
+                 " X" + QByteArray::number(values[0], 'f', 2) +
+                 " Y" + QByteArray::number(values[1], 'f', 2) +
+                 " Z" + QByteArray::number(values[2], 'f', 2) +
+                 (code == "M203" ? " E25.00\n" : " E10000.00\n"));
+        }
+        send("ok\n");
+        return true;
+    }
+
+    if (code == "M105")
+    {
+        send("ok T:25.00 /0.00 B:25.00 /0.00 @:0 B@:0\n");
+        return true;
+    }
+
+    // Accepted without effect
+    static const char *const noOps[] = {"G21", "M17", "M18", "M82", "M83", "M84", "M104", "M106", "M107", "M110", "M140"};
+    bool known = false;
+    for (const char *noOp : noOps)
+        known = known || code == noOp;
+    if (!known)
+        send("echo:Unknown command: \"" + raw + "\"\n");
+    send("ok\n");
+    return true;
+}
+
+void FirmwareSimulator::emergencyStop(bool kill)
+{
+    // Motion stops where it is and everything not yet executed is discarded
+    double pos[3];
+    currentPosition(pos);
+    for (int axis = 0; axis < 3; ++axis)
+        m_position[axis] = m_target[axis] = pos[axis];
+    m_blocks.clear();
+    m_pendingLines.clear();
+    m_homing = false;
+
+    // Real firmware needs a reset after M112; the simulator carries on so a
+    // session can continue after the error
+    if (kill)
+        send("Error:Printer halted. kill() called!\n");
+    else
+        send("ok\n");
+}
+
+void FirmwareSimulator::queueMove(const double to[3], qint64 durationMs)
+{
+    Block block;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        block.from[axis] = m_target[axis];
+        block.to[axis] = to[axis];
+        m_target[axis] = to[axis];
+    }
+    block.durationMs = durationMs;
+    if (m_blocks.isEmpty())
+        m_blockStartMs = m_clock.elapsed();
+    m_blocks.enqueue(block);
+}
+
+void FirmwareSimulator::advance()
+{
+    const qint64 now = m_clock.elapsed();
+    bool finished = false;
+    while (!m_blocks.isEmpty() && now - m_blockStartMs >= m_blocks.head().durationMs)
+    {
+        const Block block = m_blocks.dequeue();
+        for (int axis = 0; axis < 3; ++axis)
+            m_position[axis] = block.to[axis];
+        m_blockStartMs += block.durationMs;
+        finished = true;
+    }
+    if (finished)
+        processPending();
+}
+
+void FirmwareSimulator::currentPosition(double pos[3]) const
+{
+    if (m_blocks.isEmpty())
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            pos[axis] = m_position[axis];
+        return;
+    }
+
+    const Block &block = m_blocks.head();
+    const double t = block.durationMs > 0 ? qBound(0.0, double(m_clock.elapsed() - m_blockStartMs) / block.durationMs, 1.0) : 1.0;
+    for (int axis = 0; axis < 3; ++axis)
+        pos[axis] = block.from[axis] + (block.to[axis] - block.from[axis]) * t;
+}
+
+QByteArray FirmwareSimulator::positionReport() const
+{
+    double pos[3];
+    currentPosition(pos);
+    return "X:" + QByteArray::number(pos[0], 'f', 2) +
+           " Y:" + QByteArray::number(pos[1], 'f', 2) +
+           " Z:" + QByteArray::number(pos[2], 'f', 2) +
+           " E:0.00 Count X:" + QByteArray::number(qRound64(pos[0] * m_config.stepsPerMm[0])) +
+           " Y:" + QByteArray::number(qRound64(pos[1] * m_config.stepsPerMm[1])) +
+           " Z:" + QByteArray::number(qRound64(pos[2] * m_config.stepsPerMm[2])) + "\n";
+}
+
+void FirmwareSimulator::tick()
+{
+    advance();
+
+    const qint64 now = m_clock.elapsed();
+    if (!m_pendingLines.isEmpty() && m_config.busyIntervalMs > 0 && now - m_lastBusyMs >= m_config.busyIntervalMs)
+    {
+        send("echo:busy: processing\n");
+        m_lastBusyMs = now;
+    }
+    if (m_autoReportMs > 0 && now - m_lastAutoReportMs >= m_autoReportMs)
+    {
+        send(positionReport());
+        m_lastAutoReportMs = now;
+    }
+    updateTimer();
+}
+
+void FirmwareSimulator::send(const QByteArray &text)
+{
+    if (m_master < 0)
+        return;
+
+    // Nobody reading the slave side: drop output instead of blocking
+    const char *data = text.constData();
+    qint64 left = text.size();
+    while (left > 0)
+    {
+        const ssize_t n = ::write(m_master, data, size_t(left));
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            qWarning() << "Simulator output dropped:" << left << "bytes";
+            break;
+        }
+        data += n;
+        left -= n;
+    }
+    emit replySent(text);
+}
+
+void FirmwareSimulator::updateTimer()
+{
+    const bool needed = m_master >= 0 && (!m_blocks.isEmpty() || !m_pendingLines.isEmpty() || m_autoReportMs > 0);
+    if (needed && !m_tickTimer.isActive())
+        m_tickTimer.start();
+    else if (!needed)
+        m_tickTimer.stop();
+}
@@ -0,0 +1,107 @@
+// FirmwareSimulator.h
+#ifndef FIRMWARESIMULATOR_H
+#define FIRMWARESIMULATOR_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QTimer>
+#include "MotionPlanner.h"
+
+class QSocketNotifier;
+
+struct SimulatorConfig
+{
+    int plannerDepth = 16;       // Moves buffered before "ok" is held back (BLOCK_BUFFER_SIZE)
+    int moveTimeMs = -1;         // Fixed execution time per move; < 0 derives it from length and feedrate
+    int busyIntervalMs = 2000;   // "busy: processing" keepalive while a command waits
+    int homingTimeMs = 1500;     // Duration of G28
+    int corruptEvery = 0;        // Reject every Nth numbered line as corrupted (0 = never)
+    double stepsPerMm[3] = {80.0, 80.0, 400.0};
+    MotionLimits limits;         // Reported by M203/M201 and applied to feedrates
+};
+
+// Marlin stand-in on a Linux pseudo-terminal. Clients open portName() like any
+// serial device. Moves are acknowledged when they fit into the planner buffer
+// and then executed in simulated time, so "ok" pacing, busy keepalives, M114
+// and M154 position reports behave like a board with the configured buffer
+// depth. M114 reports the interpolated position of the moving axes, and
+// M112/M410 are handled on arrival as with Marlin's EMERGENCY_PARSER. Lines
+// sent as "N<line> ...*<checksum>" are checked on arrival too, and rejected
+// ones answered with "Error:...", "Resend: <n>" and "ok" as Marlin does;
+// complete lines already received behind a rejected one are dropped.
+class FirmwareSimulator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FirmwareSimulator(const SimulatorConfig &config = SimulatorConfig(), QObject *parent = nullptr);
+    ~FirmwareSimulator();
+
+    bool open(QString *error = nullptr);
+    void close();
+    bool isOpen() const { return m_master >= 0; }
+    QString portName() const { return m_portName; } // Slave device, e.g. /dev/pts/3
+
+    const SimulatorConfig &config() const { return m_config; }
+    quint64 linesReceived() const { return m_linesReceived; }
+    quint64 resendsRequested() const { return m_resendsRequested; }
+    int queuedMoves() const { return m_blocks.size(); }
+
+signals:
+    void commandReceived(const QByteArray &line);
+    void replySent(const QByteArray &text);
+
+private slots:
+    void onReadable();
+    void tick();
+
+private:
+    struct Block
+    {
+        double from[3];
+        double to[3];
+        qint64 durationMs = 0;
+    };
+
+    SimulatorConfig m_config;
+    int m_master = -1;
+    int m_slave = -1; // Held open so the master never sees a hangup between clients
+    QString m_portName;
+    QSocketNotifier *m_notifier = nullptr;
+    QTimer m_tickTimer;
+    QElapsedTimer m_clock;
+
+    QByteArray m_rx;
+    QQueue<QByteArray> m_pendingLines; // Received, not yet executed
+    QQueue<Block> m_blocks;            // Planned moves; the head is executing
+    qint64 m_blockStartMs = 0;
+    qint64 m_lastBusyMs = 0;
+    quint64 m_linesReceived = 0;
+    qint64 m_lastLineNumber = 0;
+    quint64 m_numberedLines = 0; // Accepted so far, for corruptEvery
+    quint64 m_resendsRequested = 0;
+
+    double m_position[3] = {0.0, 0.0, 0.0}; // End of the last completed block
+    double m_target[3] = {0.0, 0.0, 0.0};   // End of the last planned block
+    double m_feedrate = 1000.0;             // mm/min
+    bool m_relative = false;
+    bool m_homing = false;
+    int m_autoReportMs = 0;
+    qint64 m_lastAutoReportMs = 0;
+
+    static bool isEmergencyCommand(const QByteArray &line);
+    bool acceptLine(QByteArray &line);
+    bool requestResend(const char *reason);
+    void processPending();
+    bool execute(const QByteArray &line);
+    void emergencyStop(bool kill);
+    void queueMove(const double to[3], qint64 durationMs);
+    void advance();
+    void currentPosition(double pos[3]) const;
+    QByteArray positionReport() const;
+    void send(const QByteArray &text);
+    void updateTimer();
+};
+
+#endif // FIRMWARESIMULATOR_H
@@ -0,0 +1,112 @@
+// SimulatorMain.cpp
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <csignal>
+#include <cstdio>
+#include <unistd.h>
+#include "FirmwareSimulator.h"
+
+namespace
+{
+int signalPipe[2] = {-1, -1};
+
+// Only async-signal-safe work here; the event loop quits, so the link is removed
+void onSignal(int signal)
+{
+    const char byte = char(signal);
+    if (::write(signalPipe[1], &byte, 1) < 0)
+        return;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("TinyBeeSim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated TinyBee/Marlin board on a pseudo-terminal");
+    parser.addHelpOption();
+    QCommandLineOption depthOption("depth", "Planner buffer depth in moves (default 16).", "moves", "16");
+    QCommandLineOption moveTimeOption("move-time", "Fixed execution time per move; -1 uses length and feedrate (default).", "ms", "-1");
+    QCommandLineOption busyOption("busy-interval", "busy: processing keepalive interval, 0 = off (default 2000).", "ms", "2000");
+    QCommandLineOption homingOption("homing-time", "Duration of G28 (default 1500).", "ms", "1500");
+    QCommandLineOption corruptOption("corrupt-every", "Reject every Nth line sent with a checksum, to exercise resends (default 0 = never).", "lines", "0");
+    QCommandLineOption linkOption("link", "Create a symlink to the pseudo-terminal, e.g. /tmp/ttyTinyBee.", "path");
+    QCommandLineOption verboseOption("verbose", "Print every received line and reply.");
+    parser.addOption(depthOption);
+    parser.addOption(moveTimeOption);
+    parser.addOption(busyOption);
+    parser.addOption(homingOption);
+    parser.addOption(corruptOption);
+    parser.addOption(linkOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    SimulatorConfig config;
+    config.plannerDepth = parser.value(depthOption).toInt();
+    config.moveTimeMs = parser.value(moveTimeOption).toInt();
+    config.busyIntervalMs = parser.value(busyOption).toInt();
+    config.homingTimeMs = parser.value(homingOption).toInt();
+    config.corruptEvery = parser.value(corruptOption).toInt();
+
+    FirmwareSimulator simulator(config);
+    QString error;
+    if (!simulator.open(&error))
+    {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    QString portName = simulator.portName();
+    const QString link = parser.value(linkOption);
+    if (!link.isEmpty())
+    {
+        // A stale link from an earlier run is replaced; anything else is left alone
+        const QFileInfo existing(link);
+        if (existing.isSymLink())
+            QFile::remove(link);
+        else if (existing.exists())
+        {
+            std::fprintf(stderr, "%s exists and is not a symlink\n", qPrintable(link));
+            return 1;
+        }
+        if (!QFile::link(simulator.portName(), link))
+        {
+            std::fprintf(stderr, "Failed to create link %s\n", qPrintable(link));
+            return 1;
+        }
+        portName = link;
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [link]()
+                         {
+            if (QFileInfo(link).isSymLink())
+                QFile::remove(link); });
+    }
+
+    if (::pipe(signalPipe) == 0)
+    {
+        QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, &app);
+        QObject::connect(notifier, &QSocketNotifier::activated, &app, []()
+                         {
+            char byte = 0;
+            if (::read(signalPipe[0], &byte, 1) == 1)
+                QCoreApplication::quit(); });
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+    }
+
+    if (parser.isSet(verboseOption))
+    {
+        QObject::connect(&simulator, &FirmwareSimulator::commandReceived, [](const QByteArray &line)
+                         { std::printf("> %s\n", line.constData()); std::fflush(stdout); });
+        QObject::connect(&simulator, &FirmwareSimulator::replySent, [](const QByteArray &text)
+                         { std::printf("< %s", text.constData()); std::fflush(stdout); });
+    }
+
+    std::printf("TinyBee simulator on %s (planner depth %d)\n", qPrintable(portName), config.plannerDepth);
+    std::fflush(stdout);
+    return app.exec();
+}